@@ -43,10 +43,9 @@ inline [[cppgen::auto]] std::string to_json(const Header& o, bool verbose)
 {
     return std::string()
     // clang-format off
-    + "{"
-    + to_json("Start")  + ':' + (isnull(o.start)  ? to_json(nullptr, verbose) : to_json(o.start , verbose)) + ','
-    + to_json("Length") + ':' + (isnull(o.length) ? to_json(nullptr, verbose) : to_json(o.length, verbose)) + ','
-    + to_json("Type")   + ':' + (isnull(o.type)   ? to_json(nullptr, verbose) : to_json(o.type  , verbose))
+    + "{\"Start\":"  + (isnull(o.start)  ? to_json(nullptr, verbose) : to_json(o.start , verbose))
+    + ",\"Length\":" + (isnull(o.length) ? to_json(nullptr, verbose) : to_json(o.length, verbose))
+    + ",\"Type\":"   + (isnull(o.type)   ? to_json(nullptr, verbose) : to_json(o.type  , verbose))
     + "}";
     // clang-format on
 }
@@ -54,6 +54,9 @@ struct NewOrder
 };
 #pragma pack()
 
+// Type aliases get the code of the aliased type, here the time in force enumeration declared in Types.h
+using TimeInForce = TIF;
+
 inline [[cppgen::auto]] std::ostream& operator<<(std::ostream& s, const NewOrder& o)
 {
     // clang-format off
@@ -94,35 +97,34 @@ inline [[cppgen::auto]] std::string to_json(const NewOrder& o, bool verbose)
 {
     return std::string()
     // clang-format off
-    + "{"
-    + to_json("Header")                  + ':' + (isnull(o.header)                  ? to_json(nullptr, verbose) : to_json(o.header                 , verbose)) + ','
-    + to_json("ClientOrderId")           + ':' + (isnull(o.clientOrderId)           ? to_json(nullptr, verbose) : to_json(o.clientOrderId          , verbose)) + ','
-    + to_json("TraderId")                + ':' + (isnull(o.traderId)                ? to_json(nullptr, verbose) : to_json(o.traderId               , verbose)) + ','
-    + to_json("Account")                 + ':' + (isnull(o.account)                 ? to_json(nullptr, verbose) : to_json(o.account                , verbose)) + ','
-    + to_json("ClearingAccount")         + ':' + (isnull(o.clearingAccount)         ? to_json(nullptr, verbose) : to_json(o.clearingAccount        , verbose)) + ','
-    + to_json("InstrumentId")            + ':' + (isnull(o.instrumentId)            ? to_json(nullptr, verbose) : to_json(o.instrumentId           , verbose)) + ','
-    + to_json("MifidFlags")              + ':' + (isnull(o.mifidFlags)              ? to_json(nullptr, verbose) : to_json(o.mifidFlags             , verbose)) + ','
-    + to_json("PartyRoleQualifiers")     + ':' + (isnull(o.partyRoleQualifiers)     ? to_json(nullptr, verbose) : to_json(o.partyRoleQualifiers    , verbose)) + ','
-    + to_json("OrderType")               + ':' + (isnull(o.orderType)               ? to_json(nullptr, verbose) : to_json(o.orderType              , verbose)) + ','
-    + to_json("TimeInForce")             + ':' + (isnull(o.timeInForce)             ? to_json(nullptr, verbose) : to_json(o.timeInForce            , verbose)) + ','
-    + to_json("ExpireDateTime")          + ':' + (isnull(o.expireDateTime)          ? to_json(nullptr, verbose) : to_json(o.expireDateTime         , verbose)) + ','
-    + to_json("Side")                    + ':' + (isnull(o.side)                    ? to_json(nullptr, verbose) : to_json(o.side                   , verbose)) + ','
-    + to_json("OrderQty")                + ':' + (isnull(o.orderQty)                ? to_json(nullptr, verbose) : to_json(o.orderQty               , verbose)) + ','
-    + to_json("DisplayQty")              + ':' + (isnull(o.displayQty)              ? to_json(nullptr, verbose) : to_json(o.displayQty             , verbose)) + ','
-    + to_json("Price")                   + ':' + (isnull(o.price)                   ? to_json(nullptr, verbose) : to_json(o.price                  , verbose)) + ','
-    + to_json("Capacity")                + ':' + (isnull(o.capacity)                ? to_json(nullptr, verbose) : to_json(o.capacity               , verbose)) + ','
-    + to_json("AutoCancel")              + ':' + (isnull(o.autoCancel)              ? to_json(nullptr, verbose) : to_json(o.autoCancel             , verbose)) + ','
-    + to_json("OrderSubType")            + ':' + (isnull(o.orderSubType)            ? to_json(nullptr, verbose) : to_json(o.orderSubType           , verbose)) + ','
-    + to_json("Anonymity")               + ':' + (isnull(o.anonymity)               ? to_json(nullptr, verbose) : to_json(o.anonymity              , verbose)) + ','
-    + to_json("StopPrice")               + ':' + (isnull(o.stopPrice)               ? to_json(nullptr, verbose) : to_json(o.stopPrice              , verbose)) + ','
-    + to_json("PassiveOnlyOrder")        + ':' + (isnull(o.passiveOnlyOrder)        ? to_json(nullptr, verbose) : to_json(o.passiveOnlyOrder       , verbose)) + ','
-    + to_json("ClientId")                + ':' + (isnull(o.clientId)                ? to_json(nullptr, verbose) : to_json(o.clientId               , verbose)) + ','
-    + to_json("InvestmentDecisionMaker") + ':' + (isnull(o.investmentDecisionMaker) ? to_json(nullptr, verbose) : to_json(o.investmentDecisionMaker, verbose)) + ','
-    + to_json("GroupId")                 + ':' + (isnull(o.groupId)                 ? to_json(nullptr, verbose) : to_json(o.groupId                , verbose)) + ','
-    + to_json("MinimumQuantity")         + ':' + (isnull(o.minimumQuantity)         ? to_json(nullptr, verbose) : to_json(o.minimumQuantity        , verbose)) + ','
-    + to_json("ExecutingTrader")         + ':' + (isnull(o.executingTrader)         ? to_json(nullptr, verbose) : to_json(o.executingTrader        , verbose)) + ','
-    + to_json("Offset")                  + ':' + (isnull(o.offset)                  ? to_json(nullptr, verbose) : to_json(o.offset                 , verbose)) + ','
-    + to_json("Reserved")                + ':' + (isnull(o.reserved)                ? to_json(nullptr, verbose) : to_json(o.reserved               , verbose))
+    + "{\"Header\":"                  + (isnull(o.header)                  ? to_json(nullptr, verbose) : to_json(o.header                 , verbose))
+    + ",\"ClientOrderId\":"           + (isnull(o.clientOrderId)           ? to_json(nullptr, verbose) : to_json(o.clientOrderId          , verbose))
+    + ",\"TraderId\":"                + (isnull(o.traderId)                ? to_json(nullptr, verbose) : to_json(o.traderId               , verbose))
+    + ",\"Account\":"                 + (isnull(o.account)                 ? to_json(nullptr, verbose) : to_json(o.account                , verbose))
+    + ",\"ClearingAccount\":"         + (isnull(o.clearingAccount)         ? to_json(nullptr, verbose) : to_json(o.clearingAccount        , verbose))
+    + ",\"InstrumentId\":"            + (isnull(o.instrumentId)            ? to_json(nullptr, verbose) : to_json(o.instrumentId           , verbose))
+    + ",\"MifidFlags\":"              + (isnull(o.mifidFlags)              ? to_json(nullptr, verbose) : to_json(o.mifidFlags             , verbose))
+    + ",\"PartyRoleQualifiers\":"     + (isnull(o.partyRoleQualifiers)     ? to_json(nullptr, verbose) : to_json(o.partyRoleQualifiers    , verbose))
+    + ",\"OrderType\":"               + (isnull(o.orderType)               ? to_json(nullptr, verbose) : to_json(o.orderType              , verbose))
+    + ",\"TimeInForce\":"             + (isnull(o.timeInForce)             ? to_json(nullptr, verbose) : to_json(o.timeInForce            , verbose))
+    + ",\"ExpireDateTime\":"          + (isnull(o.expireDateTime)          ? to_json(nullptr, verbose) : to_json(o.expireDateTime         , verbose))
+    + ",\"Side\":"                    + (isnull(o.side)                    ? to_json(nullptr, verbose) : to_json(o.side                   , verbose))
+    + ",\"OrderQty\":"                + (isnull(o.orderQty)                ? to_json(nullptr, verbose) : to_json(o.orderQty               , verbose))
+    + ",\"DisplayQty\":"              + (isnull(o.displayQty)              ? to_json(nullptr, verbose) : to_json(o.displayQty             , verbose))
+    + ",\"Price\":"                   + (isnull(o.price)                   ? to_json(nullptr, verbose) : to_json(o.price                  , verbose))
+    + ",\"Capacity\":"                + (isnull(o.capacity)                ? to_json(nullptr, verbose) : to_json(o.capacity               , verbose))
+    + ",\"AutoCancel\":"              + (isnull(o.autoCancel)              ? to_json(nullptr, verbose) : to_json(o.autoCancel             , verbose))
+    + ",\"OrderSubType\":"            + (isnull(o.orderSubType)            ? to_json(nullptr, verbose) : to_json(o.orderSubType           , verbose))
+    + ",\"Anonymity\":"               + (isnull(o.anonymity)               ? to_json(nullptr, verbose) : to_json(o.anonymity              , verbose))
+    + ",\"StopPrice\":"               + (isnull(o.stopPrice)               ? to_json(nullptr, verbose) : to_json(o.stopPrice              , verbose))
+    + ",\"PassiveOnlyOrder\":"        + (isnull(o.passiveOnlyOrder)        ? to_json(nullptr, verbose) : to_json(o.passiveOnlyOrder       , verbose))
+    + ",\"ClientId\":"                + (isnull(o.clientId)                ? to_json(nullptr, verbose) : to_json(o.clientId               , verbose))
+    + ",\"InvestmentDecisionMaker\":" + (isnull(o.investmentDecisionMaker) ? to_json(nullptr, verbose) : to_json(o.investmentDecisionMaker, verbose))
+    + ",\"GroupId\":"                 + (isnull(o.groupId)                 ? to_json(nullptr, verbose) : to_json(o.groupId                , verbose))
+    + ",\"MinimumQuantity\":"         + (isnull(o.minimumQuantity)         ? to_json(nullptr, verbose) : to_json(o.minimumQuantity        , verbose))
+    + ",\"ExecutingTrader\":"         + (isnull(o.executingTrader)         ? to_json(nullptr, verbose) : to_json(o.executingTrader        , verbose))
+    + ",\"Offset\":"                  + (isnull(o.offset)                  ? to_json(nullptr, verbose) : to_json(o.offset                 , verbose))
+    + ",\"Reserved\":"                + (isnull(o.reserved)                ? to_json(nullptr, verbose) : to_json(o.reserved               , verbose))
     + "}";
     // clang-format on
 }
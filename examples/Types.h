@@ -1,15 +1,31 @@
 #ifndef Types_dot_h
 #define Types_dot_h
 
+#include "format_to.h"
+#include "parse.h"
+#include "to_fix.h"
 #include "to_json.h"
 
 #include <array>
 #include <charconv>
 #include <cstdint>
+#include <cstring>
 #include <ctime>
+#include <limits>
 
 namespace LSE {
 
+using detail::fix_checksum;
+using detail::fix_field;
+using detail::fix_literal;
+using detail::fix_value;
+using detail::format_to;
+using detail::max_json_size;
+using detail::max_text_size;
+using detail::parse;
+using detail::parse_field;
+using detail::parse_literal;
+using detail::parse_until;
 using detail::to_json;
 
 // To demonstrate null check in JSON serialization we provide this dummy function
@@ -42,6 +58,48 @@ to_utcstring(const struct timeval& tv, unsigned precision = 6)
     return buffer;
 }
 
+// Parse YYYYMMDD-HH:MM:SS with optional fraction of up to six digits, the inverse of to_utcstring
+inline bool
+parse_utcstring(std::string_view v, std::time_t& seconds, long& micros)
+{
+    auto field = [&v](std::size_t pos, std::size_t len, int& out) {
+        auto res = std::from_chars(v.data() + pos, v.data() + pos + len, out);
+        return res.ec == std::errc() && res.ptr == v.data() + pos + len;
+    };
+
+    int y, m, d, hh, mm, ss;
+    if (v.size() < 17 || v[8] != '-' || v[11] != ':' || v[14] != ':' || !field(0, 4, y) || !field(4, 2, m) ||
+        !field(6, 2, d) || !field(9, 2, hh) || !field(12, 2, mm) || !field(15, 2, ss)) {
+        return false;
+    }
+
+    micros = 0;
+    if (v.size() > 17) {
+        if (v[17] != '.' || v.size() > 24) {
+            return false;
+        }
+        int fraction = 0;
+        if (!field(18, v.size() - 18, fraction)) {
+            return false;
+        }
+        micros = fraction;
+        for (std::size_t i = v.size() - 18; i < 6; ++i) {
+            micros *= 10;
+        }
+    }
+
+    // Days since the epoch of the proleptic Gregorian calendar date
+    y -= m <= 2;
+    const long era = (y >= 0 ? y : y - 399) / 400;
+    const long yoe = y - era * 400;
+    const long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    const long days = era * 146097 + doe - 719468;
+
+    seconds = static_cast<std::time_t>(days * 86400 + hh * 3600 + mm * 60 + ss);
+    return true;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 // Message field data types
 //---------------------------------------------------------------------------------------------------------------------
@@ -80,12 +138,57 @@ struct Price
         return div.quot + double(div.rem) / multiplier;
     }
 
+    // Quoted fixed notation with eight decimals followed by the raw value in parentheses
+    static constexpr std::size_t max_json_size()
+    {
+        return 2 + 21 + 2 + std::numeric_limits<int64_t>::digits10 + 2 + 1;
+    }
+    static constexpr std::size_t max_text_size()
+    {
+        return std::numeric_limits<int64_t>::digits10 + 2;
+    }
+
     friend std::ostream& operator<<(std::ostream& os, const Price& p)
     {
         os << p.value;
         return os;
     }
 
+    friend char* format_to(char* out, char* end, const Price& p)
+    {
+        return format_to(out, end, p.value);
+    }
+
+    // Printed as the raw value, not as a decimal number
+    friend bool parse(std::string_view v, Price& p)
+    {
+        return parse(v, p.value);
+    }
+
+    // FIX price, decimal number without trailing zeros
+    friend char* to_fix(char* out, const Price& p)
+    {
+        if (p.value < 0) {
+            *out++ = '-';
+        }
+        auto magnitude = p.value < 0 ? 0 - static_cast<uint64_t>(p.value) : static_cast<uint64_t>(p.value);
+        out            = std::to_chars(out, out + 20, magnitude / multiplier).ptr;
+        if (auto fraction = magnitude % multiplier; fraction != 0) {
+            char digits[8];
+            for (int i = 7; i >= 0; --i, fraction /= 10) {
+                digits[i] = static_cast<char>('0' + fraction % 10);
+            }
+            int len = 8;
+            while (digits[len - 1] == '0') {
+                --len;
+            }
+            *out++ = '.';
+            std::memcpy(out, digits, len);
+            out += len;
+        }
+        return out;
+    }
+
     friend std::string to_json(const Price& o, bool verbose)
     {
         if (verbose) {
@@ -165,6 +268,16 @@ struct String
         return value.size();
     }
 
+    // Every character may need a six character escape sequence
+    static constexpr std::size_t max_json_size()
+    {
+        return 2 + 6 * N;
+    }
+    static constexpr std::size_t max_text_size()
+    {
+        return N;
+    }
+
     friend std::ostream& operator<<(std::ostream& os, const String& s)
     {
         os.write(s.value.data(),
@@ -172,6 +285,11 @@ struct String
         return os;
     }
 
+    friend char* format_to(char* out, char* end, const String& s)
+    {
+        return format_to(out, end, s.operator std::string_view());
+    }
+
     friend std::string to_json(const String& o, bool verbose)
     {
         return to_json(o.operator std::string_view(), verbose);
@@ -211,6 +329,15 @@ struct Alpha
         return { &value, 1 };
     }
 
+    static constexpr std::size_t max_json_size()
+    {
+        return 8;
+    }
+    static constexpr std::size_t max_text_size()
+    {
+        return 1;
+    }
+
     friend std::ostream& operator<<(std::ostream& os, const Alpha& t)
     {
         if (t.value != 0) {
@@ -219,6 +346,18 @@ struct Alpha
         return os;
     }
 
+    friend char* format_to(char* out, char* end, const Alpha& t)
+    {
+        return t.value != 0 ? format_to(out, end, t.value) : out;
+    }
+
+    // Null character is printed as nothing
+    friend bool parse(std::string_view v, Alpha& t)
+    {
+        t.value = 0;
+        return v.empty() || parse(v, t.value);
+    }
+
     friend std::string to_json(const Alpha& o, bool verbose)
     {
         return to_json(o.operator std::string_view(), verbose);
@@ -278,6 +417,15 @@ struct Int
         return value;
     }
 
+    static constexpr std::size_t max_json_size()
+    {
+        return std::numeric_limits<T>::digits10 + 2;
+    }
+    static constexpr std::size_t max_text_size()
+    {
+        return std::numeric_limits<T>::digits10 + 2;
+    }
+
     friend std::ostream& operator<<(std::ostream& os, const Int& i)
     {
         if constexpr (std::is_same_v<int8_t, decltype(i.value)>) {
@@ -290,6 +438,22 @@ struct Int
         return os;
     }
 
+    // Eight bit integers are printed as numbers, same as the output stream shift operator
+    friend char* format_to(char* out, char* end, const Int& i)
+    {
+        return format_to(out, end, i.value);
+    }
+
+    friend bool parse(std::string_view v, Int& i)
+    {
+        return parse(v, i.value);
+    }
+
+    friend char* to_fix(char* out, const Int& i)
+    {
+        return std::to_chars(out, out + 24, i.value).ptr;
+    }
+
     inline std::string to_json(const Int<T>& o, bool)
     {
         return to_string(o);
@@ -374,12 +538,38 @@ struct ExpirationTime
         return buffer;
     }
 
+    // YYYYMMDD-HH:MM:SS
+    static constexpr std::size_t max_json_size()
+    {
+        return 2 + 17;
+    }
+    static constexpr std::size_t max_text_size()
+    {
+        return 17;
+    }
+
     friend std::ostream& operator<<(std::ostream& os, const ExpirationTime& i)
     {
         os << std::string_view(i);
         return os;
     }
 
+    friend char* format_to(char* out, char* end, const ExpirationTime& i)
+    {
+        return format_to(out, end, std::string_view(i));
+    }
+
+    friend bool parse(std::string_view v, ExpirationTime& i)
+    {
+        std::time_t seconds;
+        long        micros;
+        if (v.size() != 17 || !parse_utcstring(v, seconds, micros)) {
+            return false;
+        }
+        i.value = static_cast<uint32_t>(seconds);
+        return true;
+    }
+
     friend std::string to_json(const ExpirationTime& o, bool verbose)
     {
         return to_json(o.operator std::string_view(), verbose);
@@ -416,11 +606,45 @@ struct TransactionTime
         return { static_cast<time_t>(value & 0x00000000ffffffff), static_cast<suseconds_t>(value >> 32) };
     }
 
+    // YYYYMMDD-HH:MM:SS.ffffff
+    static constexpr std::size_t max_json_size()
+    {
+        return 2 + 24;
+    }
+    static constexpr std::size_t max_text_size()
+    {
+        return 24;
+    }
+
     friend std::ostream& operator<<(std::ostream& os, const TransactionTime& i)
     {
         return os << to_utcstring(i);
     }
 
+    friend char* format_to(char* out, char* end, const TransactionTime& i)
+    {
+        return format_to(out, end, std::string_view(to_utcstring(i)));
+    }
+
+    friend bool parse(std::string_view v, TransactionTime& i)
+    {
+        std::time_t seconds;
+        long        micros;
+        if (!parse_utcstring(v, seconds, micros)) {
+            return false;
+        }
+        i.value = (static_cast<uint64_t>(micros) << 32) | static_cast<uint32_t>(seconds);
+        return true;
+    }
+
+    // FIX UTCTimestamp with microseconds
+    friend char* to_fix(char* out, const TransactionTime& i)
+    {
+        auto s = to_utcstring(i);
+        std::memcpy(out, s.data(), s.size());
+        return out + s.size();
+    }
+
     friend std::string to_json(const TransactionTime& o, bool verbose)
     {
         return to_json(to_utcstring(o), verbose);
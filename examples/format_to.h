@@ -0,0 +1,122 @@
+#ifndef format_to_dot_h
+#define format_to_dot_h
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+namespace detail {
+
+// Text is truncated when the buffer is too small. Returned pointer is one past the last character written.
+
+template<std::size_t N>
+inline char*
+format_to(char* out, char* end, const char (&literal)[N])
+{
+    std::size_t len = std::min<std::size_t>(N - 1, end - out);
+    std::memcpy(out, literal, len);
+    return out + len;
+}
+
+inline char*
+format_to(char* out, char* end, std::string_view value)
+{
+    std::size_t len = std::min<std::size_t>(value.size(), end - out);
+    std::memcpy(out, value.data(), len);
+    return out + len;
+}
+
+// Template, so that string literals bind to the array overload and keep their compile time length
+template<typename P, std::enable_if_t<std::is_same_v<P, const char*> || std::is_same_v<P, char*>, int> = 0>
+inline char*
+format_to(char* out, char* end, P value)
+{
+    return format_to(out, end, std::string_view(value));
+}
+
+inline char*
+format_to(char* out, char* end, char value)
+{
+    if (out != end) {
+        *out++ = value;
+    }
+    return out;
+}
+
+inline char*
+format_to(char* out, char* end, bool value)
+{
+    return format_to(out, end, value ? '1' : '0');
+}
+
+template<typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+inline char*
+format_to(char* out, char* end, T value)
+{
+    auto res = std::to_chars(out, end, value);
+    return res.ec == std::errc() ? res.ptr : out;
+}
+
+template<typename T, std::size_t N>
+inline char*
+format_to(char* out, char* end, const std::array<T, N>& value)
+{
+    for (std::size_t i = 0; i < N; ++i) {
+        if (i != 0) {
+            out = format_to(out, end, ' ');
+        }
+        out = format_to(out, end, value[i]);
+    }
+    return out;
+}
+
+// Upper bound of the text size of a value of type T, as written by format_to and the output stream shift operator.
+// Classes and enumerations provide it either as a static member function or as a max_text_size(const T*) function
+// found by argument dependent lookup.
+
+template<typename T, typename = void>
+struct has_max_text_size : std::false_type
+{};
+
+template<typename T>
+struct has_max_text_size<T, std::void_t<decltype(T::max_text_size())>> : std::true_type
+{};
+
+template<typename T>
+constexpr std::size_t
+max_text_size();
+
+template<typename T, std::size_t N>
+constexpr std::size_t
+max_text_size(const std::array<T, N>*)
+{
+    return N * max_text_size<T>() + (N > 0 ? N - 1 : 0);
+}
+
+template<typename T>
+constexpr std::size_t
+max_text_size()
+{
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    if constexpr (std::is_same_v<U, bool> || std::is_same_v<U, char>) {
+        return 1;
+    } else if constexpr (std::is_integral_v<U>) {
+        return std::numeric_limits<U>::digits10 + 2;
+    } else if constexpr (std::is_floating_point_v<U>) {
+        // Sign, decimal point, exponent sign and up to five exponent digits around the shortest representation
+        return std::numeric_limits<U>::max_digits10 + 9;
+    } else if constexpr (has_max_text_size<U>::value) {
+        return U::max_text_size();
+    } else {
+        return max_text_size(static_cast<const U*>(nullptr));
+    }
+}
+
+} // namespace detail
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef parse_dot_h
+#define parse_dot_h
+
+#include <charconv>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Building blocks of the generated parsers. Input is consumed from the front of the string view, nothing is copied.
+
+// Consume the literal if the text starts with it.
+inline bool
+parse_literal(std::string_view& s, std::string_view literal)
+{
+    if (s.substr(0, literal.size()) != literal) {
+        return false;
+    }
+    s.remove_prefix(literal.size());
+    return true;
+}
+
+// Split the text in front of the delimiter into value, and consume both. Empty delimiter takes the rest of the text.
+inline bool
+parse_until(std::string_view& s, std::string_view delimiter, std::string_view& value)
+{
+    if (delimiter.empty()) {
+        value = s;
+        s.remove_prefix(s.size());
+        return true;
+    }
+    auto pos = s.find(delimiter);
+    if (pos == std::string_view::npos) {
+        return false;
+    }
+    value = s.substr(0, pos);
+    s.remove_prefix(pos + delimiter.size());
+    return true;
+}
+
+template<typename T>
+struct dependent_false : std::false_type
+{};
+
+// Parse the whole text as a value of type T. Classes and enumerations provide their own parse overloads, types
+// assignable from a string view are assigned the text.
+template<typename T>
+inline bool
+parse(std::string_view v, T& o)
+{
+    if constexpr (std::is_same_v<T, bool>) {
+        if (v == "1" || v == "0") {
+            o = v[0] == '1';
+            return true;
+        }
+        return false;
+    } else if constexpr (std::is_same_v<T, char>) {
+        if (v.size() == 1) {
+            o = v[0];
+            return true;
+        }
+        return false;
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        auto res = std::from_chars(v.data(), v.data() + v.size(), o);
+        return res.ec == std::errc() && res.ptr == v.data() + v.size();
+    } else if constexpr (std::is_assignable_v<T&, std::string_view>) {
+        o = v;
+        return true;
+    } else {
+        static_assert(dependent_false<T>::value, "No parse overload for this type");
+        return false;
+    }
+}
+
+template<typename T, typename = void>
+struct has_parse_in_place : std::false_type
+{};
+
+template<typename T>
+struct has_parse_in_place<
+  T,
+  std::void_t<decltype(parse(std::declval<std::string_view&>(), std::declval<T&>(), std::declval<std::string_view>()))>>
+  : std::true_type
+{};
+
+// Parse a field followed by the delimiter, and consume both. Classes with generated parsers consume their own text in
+// place, so the delimiter is only searched for after their last field. Other types get the text in front of it.
+template<typename T>
+inline bool
+parse_field(std::string_view& s, std::string_view delimiter, T& o)
+{
+    if constexpr (has_parse_in_place<T>::value) {
+        return parse(s, o, delimiter);
+    } else {
+        std::string_view v;
+        return parse_until(s, delimiter, v) && parse(v, o);
+    }
+}
+
+} // namespace detail
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef to_fix_dot_h
+#define to_fix_dot_h
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Building blocks of the generated FIX encoders. Output goes into a caller supplied buffer that must be large enough
+// for the whole message. Functions return the position past the written bytes.
+
+// Write the contents of a string literal.
+template<std::size_t N>
+inline char*
+fix_literal(char* out, const char (&literal)[N])
+{
+    std::memcpy(out, literal, N - 1);
+    return out + N - 1;
+}
+
+template<typename T, typename = void>
+struct has_to_fix : std::false_type
+{};
+
+template<typename T>
+struct has_to_fix<T, std::void_t<decltype(to_fix(std::declval<char*>(), std::declval<const T&>()))>> : std::true_type
+{};
+
+template<typename T>
+struct fix_dependent_false : std::false_type
+{};
+
+// Write a field value. Enumerations and other types provide their own to_fix overloads, types convertible to a string
+// view are written as they are.
+template<typename T>
+inline char*
+fix_value(char* out, const T& v)
+{
+    if constexpr (has_to_fix<T>::value) {
+        return to_fix(out, v);
+    } else if constexpr (std::is_same_v<T, bool>) {
+        *out = v ? 'Y' : 'N';
+        return out + 1;
+    } else if constexpr (std::is_same_v<T, char>) {
+        *out = v;
+        return out + 1;
+    } else if constexpr (std::is_integral_v<T>) {
+        return std::to_chars(out, out + 24, v).ptr;
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        std::string_view s = v;
+        std::memcpy(out, s.data(), s.size());
+        return out + s.size();
+    } else {
+        static_assert(fix_dependent_false<T>::value, "No to_fix overload for this type");
+        return out;
+    }
+}
+
+// Write tag=value<SOH> and add the bytes to the checksum. The tag prefix and SOH byte sum is computed by the generator.
+template<std::size_t N, typename T>
+inline char*
+fix_field(char* out, const char (&tag)[N], unsigned tagsum, const T& v, unsigned& checksum)
+{
+    out        = fix_literal(out, tag);
+    char* from = out;
+    out        = fix_value(out, v);
+    for (; from != out; ++from) {
+        checksum += static_cast<unsigned char>(*from);
+    }
+    *out++ = '\x01';
+    checksum += tagsum;
+    return out;
+}
+
+// Write the CheckSum(10) trailer field.
+inline char*
+fix_checksum(char* out, unsigned checksum)
+{
+    checksum %= 256;
+    out    = fix_literal(out, "10=");
+    out[0] = static_cast<char>('0' + checksum / 100);
+    out[1] = static_cast<char>('0' + checksum / 10 % 10);
+    out[2] = static_cast<char>('0' + checksum % 10);
+    out[3] = '\x01';
+    return out + 4;
+}
+
+} // namespace detail
+
+#endif
@@ -4,9 +4,14 @@
 #include <sstream>
 #include <iomanip>
 #include <string>
+#include <string_view>
 #include <array>
-#include <numeric>
+#include <vector>
+#include <charconv>
 #include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <type_traits>
 
 namespace detail {
 
@@ -113,32 +118,54 @@ to_json(const char value, bool)
     return '"' + escape(std::string(&value, 1)) + '"';
 }
 
+// Sequences are appended into one buffer, reserved for all elements once the size of the first one is known. Containers
+// are declared first, so that sequences of sequences find them.
+
 template<typename T, std::size_t N>
 inline std::string
-to_json(const std::array<T, N>& value, bool verbose)
+to_json(const std::array<T, N>& value, bool verbose);
+
+template<typename T, typename A>
+inline std::string
+to_json(const std::vector<T, A>& value, bool verbose);
+
+template<typename It>
+inline std::string
+sequence(It first, std::size_t size, bool verbose)
 {
-    return std::string() + "[" +
-           std::accumulate(value.begin(),
-                           value.end(),
-                           std::string(),
-                           [=](auto a, auto v) {
-                               return a.empty() ? to_json(v, verbose) : std::move(a) + ',' + to_json(v, verbose);
-                           }) +
-           "]";
+    std::string o("[");
+    for (std::size_t i = 0; i < size; ++i, ++first) {
+        if (i > 0) {
+            o += ',';
+        }
+        o += to_json(*first, verbose);
+        if (i == 0) {
+            o.reserve(o.size() * size + 1);
+        }
+    }
+    o += ']';
+    return o;
 }
 
 template<typename T>
 inline std::string
 to_json(const T* data, std::size_t size, bool verbose)
 {
-    return std::string() + "[" +
-           std::accumulate(data,
-                           data + size,
-                           std::string(),
-                           [=](auto a, auto v) {
-                               return a.empty() ? to_json(v, verbose) : std::move(a) + ',' + to_json(v, verbose);
-                           }) +
-           "]";
+    return sequence(data, size, verbose);
+}
+
+template<typename T, std::size_t N>
+inline std::string
+to_json(const std::array<T, N>& value, bool verbose)
+{
+    return sequence(value.begin(), N, verbose);
+}
+
+template<typename T, typename A>
+inline std::string
+to_json(const std::vector<T, A>& value, bool verbose)
+{
+    return sequence(value.begin(), value.size(), verbose);
 }
 
 template<std::size_t N>
@@ -148,6 +175,255 @@ to_json(const char (&literal)[N])
     return '"' + std::string(literal) + '"';
 }
 
+// Upper bound of the JSON text size of a value of type T. Classes and enumerations provide it either as a static
+// member function or as a max_json_size(const T*) function found by argument dependent lookup.
+
+template<typename T, typename = void>
+struct has_max_json_size : std::false_type
+{};
+
+template<typename T>
+struct has_max_json_size<T, std::void_t<decltype(T::max_json_size())>> : std::true_type
+{};
+
+template<typename T>
+struct is_std_array : std::false_type
+{};
+
+template<typename T, std::size_t N>
+struct is_std_array<std::array<T, N>> : std::true_type
+{};
+
+template<typename T>
+constexpr std::size_t
+max_json_size()
+{
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    if constexpr (std::is_same_v<U, std::nullptr_t>) {
+        return 4;
+    } else if constexpr (std::is_same_v<U, bool>) {
+        return 7;
+    } else if constexpr (std::is_same_v<U, char>) {
+        return 8;
+    } else if constexpr (std::is_integral_v<U>) {
+        return std::numeric_limits<U>::digits10 + 2;
+    } else if constexpr (std::is_floating_point_v<U>) {
+        // std::to_string uses fixed notation with six decimals
+        return std::numeric_limits<U>::max_exponent10 + 9;
+    } else if constexpr (is_std_array<U>::value) {
+        constexpr std::size_t n = std::tuple_size_v<U>;
+        return 2 + n * max_json_size<typename U::value_type>() + (n > 0 ? n - 1 : 0);
+    } else if constexpr (std::is_array_v<U> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<U>>, char>) {
+        // Text, each character escaped as \u00XX at most
+        return 2 + 6 * (std::extent_v<U> - 1);
+    } else if constexpr (std::is_array_v<U>) {
+        constexpr std::size_t n = std::extent_v<U>;
+        return 2 + n * max_json_size<std::remove_extent_t<U>>() + (n > 0 ? n - 1 : 0);
+    } else if constexpr (has_max_json_size<U>::value) {
+        return U::max_json_size();
+    } else {
+        return max_json_size(static_cast<const U*>(nullptr));
+    }
+}
+
+// Allocator aware serializers. Text is built in strings allocated from the given memory resource, so that an arena or a
+// monotonic buffer can back all temporaries of a message. Types without such an overload are serialized through their
+// std::string overload and copied.
+
+inline void
+escape(std::string_view s, std::pmr::string& o)
+{
+    constexpr char hex[] = "0123456789abcdef";
+    // clang-format off
+    for (char c : s) {
+        switch (c) {
+        case '"': o += "\\\""; break;
+        case '\\': o += "\\\\"; break;
+        case '\b': o += "\\b"; break;
+        case '\f': o += "\\f"; break;
+        case '\n': o += "\\n"; break;
+        case '\r': o += "\\r"; break;
+        case '\t': o += "\\t"; break;
+        default:
+            if ('\x00' <= c && c <= '\x1f') {
+                o += "\\u00";
+                o += hex[c >> 4];
+                o += hex[c & 0xf];
+            } else {
+                o += c;
+            }
+        }
+    }
+    // clang-format on
+}
+
+inline std::pmr::string
+quoted(std::string_view s, std::pmr::memory_resource* mr)
+{
+    std::pmr::string o(mr);
+    o.reserve(s.size() + 2);
+    o += '"';
+    escape(s, o);
+    o += '"';
+    return o;
+}
+
+// Numbers are printed like std::to_string does, floating point in fixed notation with six decimals
+template<typename T>
+inline std::pmr::string
+number(T value, std::pmr::memory_resource* mr)
+{
+    char buffer[max_json_size<T>()];
+    if constexpr (std::is_floating_point_v<T>) {
+        return std::pmr::string(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 6).ptr, mr);
+    } else {
+        return std::pmr::string(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr, mr);
+    }
+}
+
+inline std::pmr::string
+to_json(std::nullptr_t, bool, std::pmr::memory_resource* mr)
+{
+    return std::pmr::string("null", mr);
+}
+inline std::pmr::string
+to_json(bool value, bool, std::pmr::memory_resource* mr)
+{
+    return std::pmr::string(value ? "\"true\"" : "\"false\"", mr);
+}
+inline std::pmr::string
+to_json(int value, bool, std::pmr::memory_resource* mr)
+{
+    return number(value, mr);
+}
+inline std::pmr::string
+to_json(long value, bool, std::pmr::memory_resource* mr)
+{
+    return number(value, mr);
+}
+inline std::pmr::string
+to_json(long long value, bool, std::pmr::memory_resource* mr)
+{
+    return number(value, mr);
+}
+inline std::pmr::string
+to_json(unsigned value, bool, std::pmr::memory_resource* mr)
+{
+    return number(value, mr);
+}
+inline std::pmr::string
+to_json(unsigned long value, bool, std::pmr::memory_resource* mr)
+{
+    return number(value, mr);
+}
+inline std::pmr::string
+to_json(unsigned long long value, bool, std::pmr::memory_resource* mr)
+{
+    return number(value, mr);
+}
+inline std::pmr::string
+to_json(float value, bool, std::pmr::memory_resource* mr)
+{
+    return number(value, mr);
+}
+inline std::pmr::string
+to_json(double value, bool, std::pmr::memory_resource* mr)
+{
+    return number(value, mr);
+}
+inline std::pmr::string
+to_json(long double value, bool, std::pmr::memory_resource* mr)
+{
+    return number(value, mr);
+}
+inline std::pmr::string
+to_json(const std::string& value, bool, std::pmr::memory_resource* mr)
+{
+    return quoted(value, mr);
+}
+inline std::pmr::string
+to_json(const std::string_view& value, bool, std::pmr::memory_resource* mr)
+{
+    return quoted(value, mr);
+}
+inline std::pmr::string
+to_json(const char* value, bool, std::pmr::memory_resource* mr)
+{
+    return quoted(value, mr);
+}
+
+inline std::pmr::string
+to_json(const char value, bool, std::pmr::memory_resource* mr)
+{
+    return quoted(std::string_view(&value, 1), mr);
+}
+
+template<typename T>
+inline std::pmr::string
+to_json(const T& value, bool verbose, std::pmr::memory_resource* mr)
+{
+    return std::pmr::string(to_json(value, verbose), mr);
+}
+
+template<typename T, std::size_t N>
+inline std::pmr::string
+to_json(const std::array<T, N>& value, bool verbose, std::pmr::memory_resource* mr);
+
+template<typename T, typename A>
+inline std::pmr::string
+to_json(const std::vector<T, A>& value, bool verbose, std::pmr::memory_resource* mr);
+
+template<typename It>
+inline std::pmr::string
+sequence(It first, std::size_t size, bool verbose, std::pmr::memory_resource* mr)
+{
+    std::pmr::string o("[", mr);
+    for (std::size_t i = 0; i < size; ++i, ++first) {
+        if (i > 0) {
+            o += ',';
+        }
+        o += to_json(*first, verbose, mr);
+        if (i == 0) {
+            o.reserve(o.size() * size + 1);
+        }
+    }
+    o += ']';
+    return o;
+}
+
+template<typename T>
+inline std::pmr::string
+to_json(const T* data, std::size_t size, bool verbose, std::pmr::memory_resource* mr)
+{
+    return sequence(data, size, verbose, mr);
+}
+
+template<typename T, std::size_t N>
+inline std::pmr::string
+to_json(const std::array<T, N>& value, bool verbose, std::pmr::memory_resource* mr)
+{
+    return sequence(value.begin(), N, verbose, mr);
+}
+
+template<typename T, typename A>
+inline std::pmr::string
+to_json(const std::vector<T, A>& value, bool verbose, std::pmr::memory_resource* mr)
+{
+    return sequence(value.begin(), value.size(), verbose, mr);
+}
+
+template<std::size_t N>
+inline std::pmr::string
+to_json(const char (&literal)[N], std::pmr::memory_resource* mr)
+{
+    std::pmr::string o(mr);
+    o.reserve(N + 1);
+    o += '"';
+    o.append(literal, N - 1);
+    o += '"';
+    return o;
+}
+
 } // namespace detail
 
 #endif
@@ -11,6 +11,97 @@ M.Encloses = 2
 M.Class = 1
 M.Other = 100
 
+---------------------------------------------------------------------------------------------------
+--- Compact node store. The language server response is converted once into nodes that keep only
+--- what the generators consume, and the response tables are released. A compact node is an array
+--- of kind and role as small integers, detail, first and last line, start character and children.
+--- Missing parts are stored as false, so that the array part stays dense. The metatable resolves
+--- role, kind, detail, range and children, so compact nodes can be used like the original ones.
+---------------------------------------------------------------------------------------------------
+local KIND, ROLE, DETAIL, FIRST, LAST, CHARACTER, CHILDREN = 1, 2, 3, 4, 5, 6, 7
+
+-- Kind and role names by their integer identifiers, and the other way round
+local names = {}
+local ids   = {}
+
+-- Return integer identifier of a kind or role name, false if there is none
+local function intern(name)
+    if name == nil then
+        return false
+    end
+    local id = ids[name]
+    if id == nil then
+        table.insert(names, name)
+        id        = #names
+        ids[name] = id
+    end
+    return id
+end
+
+local Node = {}
+
+Node.__index = function(node, key)
+    if key == 'kind' then
+        return names[node[KIND]]
+    elseif key == 'role' then
+        return names[node[ROLE]]
+    elseif key == 'detail' then
+        return node[DETAIL] or nil
+    elseif key == 'children' then
+        return node[CHILDREN] or nil
+    elseif key == 'range' and node[FIRST] then
+        -- Only needed to make requests at the node position
+        return { start = { line = node[FIRST], character = node[CHARACTER] }, ['end'] = { line = node[LAST] } }
+    end
+    return nil
+end
+
+-- Convert a node and its descendants, counting converted nodes
+local function compact(node, count)
+    local children = false
+    if node.children and #node.children > 0 then
+        children = {}
+        for i, child in ipairs(node.children) do
+            children[i] = compact(child, count)
+        end
+    end
+    count[1] = count[1] + 1
+    local range = node.range
+    return setmetatable({
+        intern(node.kind),
+        intern(node.role),
+        node.detail or false,
+        range and range['start'].line or false,
+        range and range['end'].line or false,
+        range and range['start'].character or false,
+        children,
+    }, Node)
+end
+
+--- Convert a node tree into compact nodes. Compact trees are returned as they are.
+function M.compact(node)
+    if node == nil or getmetatable(node) == Node then
+        return node
+    end
+    local count  = { 0 }
+    local result = compact(node, count)
+    return result, count[1]
+end
+
+--- Return node's first and last line, nil if the node has no range.
+function M.lines(node)
+    if getmetatable(node) == Node then
+        if node[FIRST] then
+            return node[FIRST], node[LAST]
+        end
+        return nil
+    end
+    if node.range then
+        return node.range['start'].line, node.range['end'].line
+    end
+    return nil
+end
+
 --- Depth first traversal over AST tree with descend filter, pre and post order operations.
 function M.dfs(node, filt, pref, posf)
     pref(node)
@@ -53,8 +144,9 @@ end
 --- Return node details - name and range, adjusted for line numbers starting from one.
 function M.details(node)
     if node then
-        if node.range then
-            return node.role .. ' ' .. node.kind .. ' ' .. (node.detail or "<???>") .. '[' .. node.range['start'].line .. ',' .. node.range['end'].line .. ']'
+        local first, last = M.lines(node)
+        if first then
+            return node.role .. ' ' .. node.kind .. ' ' .. (node.detail or "<???>") .. '[' .. first .. ',' .. last .. ']'
         end
         return node.role .. ' ' .. node.kind .. ' ' .. (node.detail or "<???>") .. '[]'
     end
@@ -63,8 +155,11 @@ end
 
 --- Return node line span.
 function M.span(node)
-    if node and node.range then
-        return { first = node.range['start'].line, last = node.range['end'].line }
+    if node then
+        local first, last = M.lines(node)
+        if first then
+            return { first = first, last = last }
+        end
     end
     return nil
 end
@@ -103,23 +198,30 @@ end
 
 --- Returns true if the cursor line position is within the node's range
 function M.encloses(node, line)
-    return not node.range or node.range['start'].line < line and node.range['end'].line > line
+    local first, last = M.lines(node)
+    return not first or first < line and last > line
 end
 
 --- Returns true if the cursor line position is past the node's range
 function M.precedes(node, line)
-    return node.range ~= nil and node.range['end'].line < line
+    local first, last = M.lines(node)
+    return first ~= nil and last < line
 end
 
 --- Returns true if two nodes perfectly overlay each other
 function M.overlay(nodea, nodeb)
-    return nodea and nodeb and nodea.range and nodeb.range and nodea.range['end'].line == nodeb.range['end'].line and
-        nodea.range['start'].line == nodeb.range['start'].line
+    if not nodea or not nodeb then
+        return false
+    end
+    local firsta, lasta = M.lines(nodea)
+    local firstb, lastb = M.lines(nodeb)
+    return firsta ~= nil and firstb ~= nil and lasta == lastb and firsta == firstb
 end
 
 --- Returns true if the node has zero range
 function M.phantom(node)
-    return node.range ~= nil and node.range['end'].line == node.range['start'].line
+    local first, last = M.lines(node)
+    return first ~= nil and last == first
 end
 
 function M.is_type_alias(node)
@@ -138,6 +240,13 @@ function M.is_class_template(node)
     return node and node.role == "declaration" and node.kind == "ClassTemplate"
 end
 
+--- Returns true if the class node carries packed or maximum field alignment (pragma pack) attribute
+function M.is_packed(node)
+    return M.is_class(node) and M.count_children(node, function(n)
+        return n.role == "attribute" and (n.kind == "Packed" or n.kind == "MaxFieldAlignment")
+    end) > 0
+end
+
 --- If a given node it a type alias node, get the underlying (deepest level?) type part
 function M.alias_type(node)
     local type = nil
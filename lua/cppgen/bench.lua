@@ -0,0 +1,204 @@
+local ast = require('cppgen.ast')
+local gen = require('cppgen.generator')
+local log = require('cppgen.log')
+local lsp = require('cppgen.lsp')
+local rpl = require('cppgen.replay')
+
+---------------------------------------------------------------------------------------------------
+--- Generator benchmark. Replays recorded fixtures through the batch mode pipeline, that is every
+--- relevant node of the file through every enabled generator, and reports throughput and memory.
+--- The generated snippets are compared against golden output, so that performance work does not
+--- silently change the generated code. Golden files are written from the current output only when
+--- updating, a missing golden file is a failure otherwise.
+---------------------------------------------------------------------------------------------------
+
+---------------------------------------------------------------------------------------------------
+-- Global parameters. Initialized in setup.
+---------------------------------------------------------------------------------------------------
+local G = {}
+
+local M = {}
+
+-- Run the pipeline once over the replayed AST, passing every snippet to the acceptor.
+local function run_once(client, acceptor)
+    lsp.get_ast(client, function(symbols)
+        local nodes = {}
+        ast.dfs(symbols,
+            function(_)
+                return true
+            end,
+            function(node)
+                if gen.is_relevant(node) then
+                    table.insert(nodes, node)
+                end
+            end
+        )
+        for _, p in ipairs(nodes) do
+            local aliastype = ast.alias_type(p)
+            if aliastype then
+                lsp.get_type_definition(client, aliastype, function(node)
+                    gen.generate(node, p, ast.Other, acceptor)
+                end)
+            else
+                gen.generate(p, nil, ast.Other, acceptor)
+            end
+        end
+        gen.generate_all(nodes, acceptor)
+    end)
+end
+
+-- Render snippets as golden text
+local function render(snippets)
+    local lines = {}
+    for _, s in ipairs(snippets) do
+        table.insert(lines, '=== ' .. tostring(s.name) .. ' / ' .. tostring(s.trigger))
+        for _, l in ipairs(s.lines) do
+            table.insert(lines, l)
+        end
+    end
+    return table.concat(lines, '\n') .. '\n'
+end
+
+-- Read the whole file, nil if it does not exist
+local function read(path)
+    local file = io.open(path, 'r')
+    if file == nil then
+        return nil
+    end
+    local text = file:read('*a')
+    file:close()
+    return text
+end
+
+-- Write the whole file
+local function write(path, text)
+    local file = io.open(path, 'w')
+    if file then
+        file:write(text)
+        file:close()
+    end
+end
+
+-- Compare the text against the golden file. Returns the status and the first differing line.
+local function compare(path, text, update)
+    if update then
+        write(path, text)
+        return 'written'
+    end
+    local golden = read(path)
+    if golden == nil then
+        write(string.gsub(path, '%.golden$', '.actual'), text)
+        return 'missing'
+    end
+    if golden == text then
+        return 'ok'
+    end
+    write(string.gsub(path, '%.golden$', '.actual'), text)
+    local line = 1
+    local actual = vim.split(text, '\n', { plain = true })
+    for i, l in ipairs(vim.split(golden, '\n', { plain = true })) do
+        if actual[i] ~= l then
+            line = i
+            break
+        end
+    end
+    return 'mismatch', line
+end
+
+-- Return a scratch buffer with the given name. A buffer left behind by an interrupted run, or any
+-- other buffer of that name, is reused, since buffer names are unique.
+local function scratch(name)
+    local path = vim.fn.fnamemodify(name, ':p')
+    for _, b in ipairs(vim.api.nvim_list_bufs()) do
+        if vim.api.nvim_buf_get_name(b) == path then
+            return b
+        end
+    end
+    local buf = vim.api.nvim_create_buf(true, false)
+    vim.api.nvim_buf_set_name(buf, name)
+    return buf
+end
+
+-- Benchmark a single fixture. Returns the report line and false on failure, golden mismatch or
+-- missing file.
+local function bench_fixture(path, iterations, update)
+    local fixture = rpl.load(path)
+    if fixture == nil then
+        return 'Unable to load ' .. path, false
+    end
+    local client = rpl.client(fixture)
+
+    -- Requests are made for the current buffer, so we name a scratch buffer after the recorded file.
+    -- Indentation is fixed, so that the golden output does not depend on user settings.
+    local prev = vim.api.nvim_get_current_buf()
+    local buf  = scratch('cppgen-bench/' .. fixture.file)
+    vim.api.nvim_set_current_buf(buf)
+    vim.bo[buf].shiftwidth = 4
+    gen.attached(client, buf)
+
+    local snippets, allocated, count, elapsed = {}, 0, 0, 0
+    local ok, err = pcall(function()
+        -- Allocation of a single pass, without collection in between
+        collectgarbage('collect')
+        collectgarbage('stop')
+        local before = collectgarbage('count')
+        run_once(client, function(s) table.insert(snippets, s) end)
+        allocated = collectgarbage('count') - before
+        collectgarbage('restart')
+
+        local start = vim.loop.hrtime()
+        for _ = 1, iterations do
+            run_once(client, function(_) count = count + 1 end)
+        end
+        elapsed = (vim.loop.hrtime() - start) / 1e9
+    end)
+    collectgarbage('restart')
+
+    -- The scratch buffer is wiped even if the run failed
+    vim.api.nvim_set_current_buf(prev)
+    vim.api.nvim_buf_delete(buf, { force = true })
+    for _, c in ipairs((vim.lsp.get_clients or vim.lsp.get_active_clients)({ bufnr = prev })) do
+        gen.attached(c, prev)
+    end
+    if not ok then
+        log.error(err)
+        return fixture.file .. ': failed, ' .. tostring(err), false
+    end
+
+    local status, line = compare(rpl.directory() .. '/' .. fixture.file .. '.golden', render(snippets), update)
+    local report = string.format('%s: %d snippets, %.0f snippets/s, %.1f KB/pass, golden %s%s',
+        fixture.file, #snippets, elapsed > 0 and count / elapsed or 0, allocated, status, line and (' at line ' .. line) or '')
+    log.info(report)
+    return report, status == 'ok' or status == 'written'
+end
+
+---------------------------------------------------------------------------------------------------
+--- Benchmark all fixtures in the fixture directory. Rewrites golden files when update is set.
+--- Returns report lines and false if any fixture fails, or its output differs from or has no golden
+--- file.
+---------------------------------------------------------------------------------------------------
+function M.run(update)
+    local reports = {}
+    local passed  = true
+    local paths   = vim.fn.glob(rpl.directory() .. '/*.json', false, true)
+    table.sort(paths)
+    for _, path in ipairs(paths) do
+        local report, ok = bench_fixture(path, G.fixtures.iterations, update)
+        table.insert(reports, report)
+        passed = passed and ok
+    end
+    if #paths == 0 then
+        table.insert(reports, 'No fixtures in ' .. rpl.directory())
+    end
+    return reports, passed
+end
+
+---------------------------------------------------------------------------------------------------
+--- Initialization callback
+---------------------------------------------------------------------------------------------------
+function M.setup(opts)
+    log.trace("setup")
+    G.fixtures = opts.fixtures
+end
+
+return M
@@ -0,0 +1,201 @@
+local ast = require('cppgen.ast')
+local log = require('cppgen.log')
+
+---------------------------------------------------------------------------------------------------
+--- Snippet cache, kept across sessions. Snippets are stored per node span and scope, along with
+--- the batch mode snippets, in one file per source file. The cache file records the hash of the
+--- file content and the hash of the options it was generated with, and is ignored when either of
+--- them does not match. Snippets are recorded only while the buffer matches the file on disk.
+---------------------------------------------------------------------------------------------------
+
+---------------------------------------------------------------------------------------------------
+-- Global parameters. Initialized in setup.
+---------------------------------------------------------------------------------------------------
+local G = {
+    opts    = nil,
+    cache   = nil,
+    options = nil,
+}
+
+local M = {}
+
+-- Cache file format version
+local VERSION = 1
+
+-- Append a deterministic text representation of a value. Table keys are sorted and functions are
+-- represented by their byte code. Values captured by functions as upvalues are not included.
+local function serialize(value, out)
+    local t = type(value)
+    if t == 'table' then
+        local keys = {}
+        for k, _ in pairs(value) do
+            table.insert(keys, k)
+        end
+        table.sort(keys, function(a, b) return tostring(a) < tostring(b) end)
+        table.insert(out, '{')
+        for _, k in ipairs(keys) do
+            table.insert(out, tostring(k))
+            table.insert(out, '=')
+            serialize(value[k], out)
+            table.insert(out, ',')
+        end
+        table.insert(out, '}')
+    elseif t == 'function' then
+        local ok, code = pcall(string.dump, value)
+        -- Functions that can not be dumped never match
+        table.insert(out, ok and code or tostring(value))
+    else
+        table.insert(out, t .. ':' .. tostring(value))
+    end
+    return out
+end
+
+-- Read the whole file, nil if it does not exist
+local function read(path)
+    local file = io.open(path, 'r')
+    if file == nil then
+        return nil
+    end
+    local text = file:read('*a')
+    file:close()
+    return text
+end
+
+-- Hash of the options and of the profile file content, which the generated code depends on as well
+local function options_hash()
+    local profile = G.opts.profile.file and read(G.opts.profile.file) or ''
+    return vim.fn.sha256(G.options .. vim.fn.sha256(profile))
+end
+
+-- Cache file path of a buffer
+local function path(bufnr)
+    local directory = G.cache.directory or vim.fn.stdpath('cache') .. '/cppgen'
+    return directory .. '/' .. vim.fn.sha256(vim.api.nvim_buf_get_name(bufnr)) .. '.json'
+end
+
+---------------------------------------------------------------------------------------------------
+--- Return the cache record for the current content of the buffer, loading it from disk if its
+--- hashes match. A new empty record is returned otherwise. Returns nil when caching is disabled or
+--- the buffer has unsaved changes.
+---------------------------------------------------------------------------------------------------
+function M.open(bufnr)
+    if not G.cache.enabled or vim.bo[bufnr].modified then
+        return nil
+    end
+    local lines   = vim.api.nvim_buf_get_lines(bufnr, 0, -1, false)
+    local content = vim.fn.sha256(table.concat(lines, '\n'))
+    local options = options_hash()
+    local file    = path(bufnr)
+
+    local text = read(file)
+    if text then
+        local ok, record = pcall(vim.json.decode, text, { luanil = { object = true, array = true } })
+        if ok and type(record) == 'table' and record.version == VERSION and record.content == content and record.options == options then
+            log.info("Loaded", #record.nodes, "cached node(s) from", log.squoted(file))
+            record.file = file
+            return record
+        end
+        log.debug("Ignoring stale cache file", log.squoted(file))
+    end
+    return { version = VERSION, content = content, options = options, nodes = {}, batch = nil, file = file }
+end
+
+-- Find the entry of a node span and scope
+local function find(record, first, last, scope)
+    for _, e in ipairs(record.nodes) do
+        if e.first == first and e.last == last and e.scope == scope then
+            return e
+        end
+    end
+    return nil
+end
+
+---------------------------------------------------------------------------------------------------
+--- Return cached snippets of the nodes preceding and enclosing the line. Mirrors the proximity
+--- node search, using the spans of the cached nodes.
+---------------------------------------------------------------------------------------------------
+function M.proximity(record, line)
+    local enclosing, preceding = nil, nil
+    for _, e in ipairs(record.nodes) do
+        if e.first < line and e.last > line and (not enclosing or e.last - e.first < enclosing.last - enclosing.first) then
+            enclosing = e
+        end
+    end
+    for _, e in ipairs(record.nodes) do
+        if e.last < line and (not enclosing or e.first > enclosing.first) and
+            (not preceding or e.last > preceding.last or e.last == preceding.last and e.first < preceding.first) then
+            preceding = e
+        end
+    end
+
+    local scope    = enclosing and enclosing.class and ast.Class or ast.Other
+    local snippets = {}
+    for _, n in ipairs({ preceding or false, enclosing or false }) do
+        local e = n and find(record, n.first, n.last, scope)
+        for _, s in ipairs(e and e.snippets or {}) do
+            table.insert(snippets, s)
+        end
+    end
+    log.debug("Found", #snippets, "cached proximity snippet(s) at line", line)
+    return snippets
+end
+
+---------------------------------------------------------------------------------------------------
+--- Start recording snippets of a node span and scope, replacing previously recorded ones. Returns
+--- function that records a snippet.
+---------------------------------------------------------------------------------------------------
+function M.recorder(record, first, last, scope, class)
+    local e = find(record, first, last, scope)
+    if e == nil then
+        e = { first = first, last = last, scope = scope, class = class }
+        table.insert(record.nodes, e)
+    end
+    e.snippets   = {}
+    record.dirty = true
+    return function(snippet)
+        table.insert(e.snippets, { name = snippet.name, trigger = snippet.trigger, lines = snippet.lines })
+    end
+end
+
+---------------------------------------------------------------------------------------------------
+--- Record the batch mode snippets.
+---------------------------------------------------------------------------------------------------
+function M.record_batch(record, snippets)
+    record.batch = {}
+    for _, s in ipairs(snippets) do
+        table.insert(record.batch, { name = s.name, trigger = s.trigger, lines = s.lines })
+    end
+    record.dirty = true
+end
+
+---------------------------------------------------------------------------------------------------
+--- Write the record if anything was recorded since it was opened.
+---------------------------------------------------------------------------------------------------
+function M.save(record)
+    if not record.dirty then
+        return
+    end
+    record.dirty = nil
+    vim.fn.mkdir(vim.fs.dirname(record.file), 'p')
+    local file = io.open(record.file, 'w')
+    if file == nil then
+        log.error("Unable to write cache file", record.file)
+        return
+    end
+    file:write(vim.json.encode({ version = record.version, content = record.content, options = record.options,
+        nodes = record.nodes, batch = record.batch }))
+    file:close()
+    log.debug("Saved", #record.nodes, "cached node(s) to", log.squoted(record.file))
+end
+
+---------------------------------------------------------------------------------------------------
+--- Initialization callback
+---------------------------------------------------------------------------------------------------
+function M.setup(opts)
+    log.trace("setup")
+    G.opts    = opts
+    G.cache   = opts.cache
+    G.options = table.concat(serialize(opts, {}))
+end
+
+return M
@@ -1,6 +1,8 @@
 local log = require('cppgen.log')
 local ast = require('cppgen.ast')
 local lsp = require('cppgen.lsp')
+local chc = require('cppgen.cache')
+local tsp = require('cppgen.treesitter')
 
 local gen = require('cppgen.generator')
 
@@ -22,18 +24,102 @@ local cmp = require('cmp')
 local G = {}
 
 ---------------------------------------------------------------------------------------------------
--- Local parameters. LSP client instance and current editor context.
+-- Local parameters. Editor context of each buffer, and a clock ordering their use.
 ---------------------------------------------------------------------------------------------------
 local L = {
-    lspclient          = nil,
-    line               = nil,
-    proximity_snippets = {},
-    preceding_snippets = {},
+    buffers = {},
+    clock   = 0,
 }
 
 --- Exported functions
 local M = {}
 
+--- Return the state of a buffer, created on first use. The state holds the LSP client attached to
+--- the buffer and the snippets collected in it, so they survive switching between buffers.
+local function state(bufnr)
+    local S = L.buffers[bufnr]
+    if S == nil then
+        S = {
+            bufnr              = bufnr,
+            client             = nil,
+            line               = nil,
+            proximity_snippets = {},
+            preceding_snippets = {},
+            batch              = nil,
+            cache              = nil,
+            used               = 0,
+            version            = 0,
+            items              = nil,
+            items_version      = nil,
+        }
+        L.buffers[bufnr] = S
+    end
+    return S
+end
+
+-- Approximate size of snippets in bytes. Tables already seen are not counted again, since batch
+-- snippets are often shared with the cache.
+local function snippets_size(snippets, seen)
+    if snippets == nil or seen[snippets] then
+        return 0
+    end
+    seen[snippets] = true
+    local size = 0
+    for _, s in ipairs(snippets) do
+        size = size + 64
+        for _, l in ipairs(s.lines) do
+            size = size + 24 + #l
+        end
+    end
+    return size
+end
+
+--- Drop snippets of the least recently used buffers until the retained snippets fit the memory
+--- budget. The current buffer is never dropped. Pending cache changes are saved before the cache is
+--- dropped.
+local function evict(current)
+    local states, total, seen = {}, 0, {}
+    for _, S in pairs(L.buffers) do
+        S.size = snippets_size(S.proximity_snippets, seen) + snippets_size(S.preceding_snippets, seen) +
+            (S.cache and snippets_size(S.cache.batch, seen) or 0)
+        total = total + S.size
+        if S ~= current then
+            table.insert(states, S)
+        end
+    end
+    table.sort(states, function(a, b) return a.used < b.used end)
+    for _, S in ipairs(states) do
+        if total <= G.buffers.budget * 1024 then
+            break
+        end
+        log.debug("Dropping", S.size, "bytes of snippets of buffer", S.bufnr)
+        total = total - S.size
+        if S.cache then
+            chc.save(S.cache)
+        end
+        S.proximity_snippets = {}
+        S.preceding_snippets = {}
+        S.batch              = nil
+        S.cache              = nil
+        S.items              = nil
+        S.version            = S.version + 1
+    end
+end
+
+--- Get AST from the configured provider and invoke callback on it.
+local function get_ast(S, callback)
+    local bufnr = S.bufnr
+    if type(G.provider) == 'function' then
+        G.provider(bufnr, function(symbols)
+            callback((ast.compact(symbols)))
+        end)
+    elseif G.provider == 'treesitter' and tsp.available(bufnr) then
+        tsp.get_ast(bufnr, callback)
+    else
+        lsp.get_ast(S.client, callback)
+    end
+end
+
 --- Scan current AST, find immediately preceding and smallest enclosing relevant nodes.
 local function find_proximity_nodes(symbols, line)
     log.trace("find_proximity_nodes at line", line)
@@ -84,15 +170,15 @@ local function find_preceding_nodes(symbols, line)
 end
 
 --- Locate immediately preceding and smallest enclosing nodes and invoke given callback on them.
-local function visit_proximity_nodes(symbols, line, callback)
+local function visit_proximity_nodes(S, symbols, line, callback)
     log.trace("Looking for proximity nodes at line", line)
     local preceding, enclosing = find_proximity_nodes(symbols, line)
     local scope = ast.is_class(enclosing) and ast.Class or ast.Other
     if preceding then
         log.debug("Selected preceding node", ast.details(preceding))
         local aliastype = ast.alias_type(preceding)
-        if aliastype and L.lspclient then
-            lsp.get_type_definition(L.lspclient, aliastype, function(node)
+        if aliastype and S.client then
+            lsp.get_type_definition(S.client, aliastype, function(node)
                 log.debug("Resolved type alias:", ast.details(preceding), "using:", ast.details(node), " line:", line)
                 callback(node, preceding, scope)
             end)
@@ -106,55 +192,138 @@ local function visit_proximity_nodes(symbols, line, callback)
     end
 end
 
---- Locate immediately preceding and smallest enclosing nodes and invoke given callback on them.
-local function visit_preceding_nodes(symbols, line, callback)
+--- Invoke given callback on preceding nodes in source order, once all type aliases are resolved.
+--- Aliases are resolved concurrently, within the LSP request limit. Must be called from a coroutine.
+local function visit_preceding_nodes(S, nodes, line, callback)
     log.trace("Looking for preceding nodes at line", line)
-    for _, p in ipairs(find_preceding_nodes(symbols, line)) do
-        log.debug("Selected preceding node", ast.details(p))
+    local client  = S.client
+    local lookups = {}
+    for i, p in ipairs(nodes) do
         local aliastype = ast.alias_type(p)
-        if aliastype and L.lspclient then
-            lsp.get_type_definition(L.lspclient, aliastype, function(node)
-                log.debug("Resolved type alias:", ast.details(p), "using:", ast.details(node), " line:", line)
-                callback(node, p, ast.Other)
-            end)
-        else
+        lookups[i] = function()
+            return aliastype and client and lsp.type_definition(client, aliastype)
+        end
+    end
+    local resolved = lsp.all(lookups)
+
+    for i, p in ipairs(nodes) do
+        log.debug("Selected preceding node", ast.details(p))
+        if not ast.alias_type(p) or not client then
             callback(p, nil, ast.Other)
+        elseif resolved[i] then
+            log.debug("Resolved type alias:", ast.details(p), "using:", ast.details(resolved[i]), " line:", line)
+            callback(resolved[i], p, ast.Other)
+        end
+    end
+end
+
+--- Generate snippets for all preceding nodes, in source order. Must be called from a coroutine.
+local function generate_preceding(S, symbols, line)
+    local snippets = {}
+    local function collect(snippet)
+        table.insert(snippets, snippet)
+        log.debug("Collected", #snippets, "preceding snippet(s)")
+    end
+    local nodes = find_preceding_nodes(symbols, line)
+    visit_preceding_nodes(S, nodes, line,
+        function(node, alias, scope)
+            gen.generate(node, alias, scope, collect, S.bufnr)
         end
+    )
+    gen.generate_all(nodes, collect)
+    return snippets
+end
+
+--- Group snippets by trigger. Triggers mapped to the same batch mode label share a group, keyed by
+--- the first of them. Returns group keys, ordered by their first snippet in the file, and the snippet
+--- texts of each group.
+local function group_snippets(snippets)
+    local groups = {}
+    local keys   = {}
+    local labels = {}
+    for _, s in ipairs(snippets) do
+        local trigger = s.trigger or s.name
+        local label   = G.batchmode.trigger and G.batchmode.trigger(trigger) or trigger
+        local key     = labels[label]
+        if key == nil then
+            key           = trigger
+            labels[label] = key
+            groups[key]   = {}
+            table.insert(keys, key)
+        end
+        table.insert(groups[key], table.concat(s.lines, '\n'))
     end
+    return keys, groups
 end
 
 ---------------------------------------------------------------------------------------------------
 --- Visit AST nodes in two passes, looking for proximity and preceding nodes.
 ---------------------------------------------------------------------------------------------------
-local function visit(symbols, line)
-    log.trace("visit line:", line)
-    visit_proximity_nodes(symbols, line,
+local function visit(S, symbols, line)
+    log.trace("visit line:", line, "buffer:", S.bufnr)
+    -- Fresh snippets replace the cached ones
+    local cache = S.cache
+    S.proximity_snippets = {}
+    S.version            = S.version + 1
+    visit_proximity_nodes(S, symbols, line,
         function(node, alias, scope)
+            local record = nil
+            if cache then
+                local first, last = ast.lines(alias or node)
+                record = first and chc.recorder(cache, first, last, scope, ast.is_class(node))
+            end
             gen.generate(node, alias, scope, function(snippet)
-                table.insert(L.proximity_snippets, snippet)
-                log.debug("Collected", #L.proximity_snippets, "proximity snippet(s)")
-            end)
+                table.insert(S.proximity_snippets, snippet)
+                S.version = S.version + 1
+                log.debug("Collected", #S.proximity_snippets, "proximity snippet(s)")
+                if record then
+                    record(snippet)
+                end
+            end, S.bufnr)
         end
     )
     if G.batchmode.enabled then
-        visit_preceding_nodes(symbols, line,
-            function(node, alias, scope)
-                gen.generate(node, alias, scope, function(snippet)
-                    table.insert(L.preceding_snippets, snippet)
-                    log.debug("Collected", #L.preceding_snippets, "preceding snippet(s)")
-                end)
+        -- Batch snippets are published all at once, when every node has been visited
+        local batch = { ready = false, waiting = {} }
+        S.batch     = batch
+        lsp.async(function()
+            local ok, snippets = pcall(generate_preceding, S, symbols, line)
+            if not ok then
+                log.error(snippets)
+            end
+
+            -- We may have entered insert mode again while waiting for the server
+            local current = ok and S.batch == batch
+            if current then
+                S.preceding_snippets = snippets
+                S.version            = S.version + 1
+                if cache then
+                    chc.record_batch(cache, snippets)
+                end
             end
-        )
+            -- Parked completion requests are answered even if the batch failed or was superseded
+            batch.ready   = true
+            local waiting = batch.waiting
+            batch.waiting = {}
+            for _, f in ipairs(waiting) do
+                f()
+            end
+            if current then
+                evict(S)
+            end
+        end)
     end
+    evict(S)
 end
 
 ---------------------------------------------------------------------------------------------------
 --- Generate code completion items.
 ---------------------------------------------------------------------------------------------------
-local function generate()
+local function generate(S)
     local total = {}
     -- Completion snippets triggered by snippet name and optionally trigger
-    for _, s in ipairs(L.proximity_snippets) do
+    for _, s in ipairs(S.proximity_snippets) do
+        local text = table.concat(s.lines, '\n')
         if s.name then
             table.insert(total,
                 {
@@ -162,8 +331,8 @@ local function generate()
                     kind             = cmp.lsp.CompletionItemKind.Snippet,
                     insertTextMode   = 2,
                     insertTextFormat = cmp.lsp.InsertTextFormat.Snippet,
-                    insertText       = table.concat(s.lines, '\n'),
-                    documentation    = table.concat(s.lines, '\n'),
+                    insertText       = text,
+                    documentation    = text,
                     --lines            = s.lines,
                 })
         end
@@ -174,8 +343,8 @@ local function generate()
                     kind             = cmp.lsp.CompletionItemKind.Snippet,
                     insertTextMode   = 2,
                     insertTextFormat = cmp.lsp.InsertTextFormat.Snippet,
-                    insertText       = table.concat(s.lines, '\n'),
-                    documentation    = table.concat(s.lines, '\n'),
+                    insertText       = text,
+                    documentation    = text,
                 })
         end
     end
@@ -183,29 +352,20 @@ local function generate()
 
     -- Batch mode code generation
     if G.batchmode.enabled then
-        -- Group all snippets by trigger
-        local groups = {}
-        for _, s in ipairs(L.preceding_snippets) do
-            local key = s.trigger or s.name
-            if G.batchmode.trigger then
-                key = G.batchmode.trigger(key)
-            end
-            if groups[key] == nil then
-                groups[key] = {}
-            end
-            table.insert(groups[key], table.concat(s.lines, '\n'))
-        end
+        -- Group all snippets by trigger, groups ordered by their first snippet in the file
+        local keys, groups = group_snippets(S.preceding_snippets)
 
-        for k, v in pairs(groups) do
+        for _, k in ipairs(keys) do
+            local text = table.concat(groups[k], '\n')
             table.insert(total,
                 -- Batch snippet
                 {
-                    label            = k,
+                    label            = G.batchmode.trigger and G.batchmode.trigger(k) or k,
                     kind             = cmp.lsp.CompletionItemKind.Snippet,
                     insertTextMode   = 2,
                     insertTextFormat = cmp.lsp.InsertTextFormat.Snippet,
-                    insertText       = table.concat(v, '\n'),
-                    documentation    = table.concat(v, '\n'),
+                    insertText       = text,
+                    documentation    = text,
                     --lines            = lines,
                 })
         end
@@ -215,6 +375,36 @@ local function generate()
     return total
 end
 
+--- Return completion items of the buffer, generated again only when its snippets change.
+local function items(S)
+    if S.items == nil or S.items_version ~= S.version then
+        S.items         = generate(S)
+        S.items_version = S.version
+    end
+    return S.items
+end
+
+--- Returns true if the characters of the prefix appear in the label in the same order, ignoring case.
+local function matches(label, prefix)
+    if prefix == '' then
+        return true
+    end
+    label  = string.lower(label)
+    prefix = string.lower(prefix)
+    if string.sub(label, 1, #prefix) == prefix then
+        return true
+    end
+    local pos = 1
+    for i = 1, #prefix do
+        pos = string.find(label, string.sub(prefix, i, i), pos, true)
+        if pos == nil then
+            return false
+        end
+        pos = pos + 1
+    end
+    return true
+end
+
 ---------------------------------------------------------------------------------------------------
 -- Start of code completion source interface.
 ---------------------------------------------------------------------------------------------------
@@ -230,7 +420,8 @@ end
 ---------------------------------------------------------------------------------------------------
 function M:is_available()
     log.trace('is_available')
-    return next(L.proximity_snippets) ~= nil or next(L.preceding_snippets) ~= nil
+    local S = L.buffers[vim.api.nvim_get_current_buf()]
+    return S ~= nil and (next(S.proximity_snippets) ~= nil or next(S.preceding_snippets) ~= nil or (S.batch ~= nil and not S.batch.ready))
 end
 
 ---------------------------------------------------------------------------------------------------
@@ -256,12 +447,11 @@ end
 ---------------------------------------------------------------------------------------------------
 --- Return the keyword pattern for triggering completion (optional).
 ---------------------------------------------------------------------------------------------------
---[[
 function M:get_keyword_pattern()
     log.trace('get_keyword_pattern')
-    return 'friend'
+    -- Triggers, function names including operators and batch mode triggers
+    return [[\h[[:alnum:]_=!<>]*]]
 end
-]]
 
 ---------------------------------------------------------------------------------------------------
 --- Return trigger characters for triggering completion (optional).
@@ -278,11 +468,32 @@ end
 ---------------------------------------------------------------------------------------------------
 function M:complete(params, callback)
     log.trace('complete:', params)
-    local items = generate()
-    if items then
-        log.trace('complete:', items)
-        callback(items)
+    -- Batch items are offered only once all preceding nodes are visited, unless cached ones are available
+    local S = L.buffers[vim.api.nvim_get_current_buf()]
+    if S == nil then
+        return
+    end
+    if S.batch and not S.batch.ready and next(S.preceding_snippets) == nil then
+        log.debug("Waiting for batch mode snippets")
+        table.insert(S.batch.waiting, function()
+            self:complete(params, callback)
+        end)
+        return
     end
+    -- Only items matching the keyword typed so far are candidates. The list is incomplete, so that it is
+    -- requested again as the keyword grows or is edited.
+    local prefix = ''
+    if params.context and params.offset then
+        prefix = string.sub(params.context.cursor_before_line, params.offset)
+    end
+    local candidates = {}
+    for _, item in ipairs(items(S)) do
+        if matches(item.label, prefix) then
+            table.insert(candidates, item)
+        end
+    end
+    log.trace('complete:', prefix, candidates)
+    callback({ items = candidates, isIncomplete = true })
 end
 
 ---------------------------------------------------------------------------------------------------
@@ -315,29 +526,65 @@ end
 function M.setup(opts)
     log.trace("setup")
     G.batchmode = opts.batchmode
+    G.provider  = opts.provider
+    G.buffers   = opts.buffers
 
+    lsp.setup(opts)
+    chc.setup(opts)
     gen.setup(opts)
 end
 
 --- LSP client attached callback
 function M.attached(client, bufnr)
     log.trace("Attached client", client.id, "buffer", bufnr)
-    L.lspclient = client
+    state(bufnr).client = client
     gen.attached(client, bufnr)
 end
 
+--- Buffer wiped out callback. Save the dirty cache and forget everything about the buffer.
+function M.wiped(bufnr)
+    log.trace("Wiped buffer:", bufnr)
+    local S = L.buffers[bufnr]
+    if S and S.cache then
+        chc.save(S.cache)
+    end
+    L.buffers[bufnr] = nil
+    gen.detached(bufnr)
+end
+
 --- Entering insert mode. Reset generators and request AST data. Upon completion visit AST nodes.
+--- Batch mode snippets collected earlier in the buffer are offered until fresh ones arrive.
 function M.insert_enter(bufnr)
     log.trace("Entered insert mode buffer:", bufnr)
 
-    L.proximity_snippets = {}
-    L.preceding_snippets = {}
-    L.line               = vim.api.nvim_win_get_cursor(0)[1] - 1
+    local S = state(bufnr)
+    L.clock = L.clock + 1
 
-    lsp.get_ast(L.lspclient, function(symbols)
+    S.used               = L.clock
+    S.proximity_snippets = {}
+    S.batch              = nil
+    S.line               = vim.api.nvim_win_get_cursor(0)[1] - 1
+
+    -- Serve cached snippets while the AST is loading
+    local tick = vim.api.nvim_buf_get_changedtick(bufnr)
+    if S.cache == nil or S.cache.tick ~= tick then
+        S.cache = chc.open(bufnr)
+        if S.cache then
+            S.cache.tick = tick
+        end
+    end
+    if S.cache then
+        S.proximity_snippets = chc.proximity(S.cache, S.line)
+        if G.batchmode.enabled and S.cache.batch and next(S.preceding_snippets) == nil then
+            S.preceding_snippets = S.cache.batch
+        end
+    end
+    S.version = S.version + 1
+
+    get_ast(S, function(symbols)
         -- We may have left insert mode by the time AST arrives
-        if L.line then
-            visit(symbols, L.line)
+        if S.line then
+            visit(S, symbols, S.line)
         end
     end
     )
@@ -346,7 +593,11 @@ end
 --- Exiting insert mode.
 function M.insert_leave(bufnr)
     log.trace("Exited insert mode buffer:", bufnr)
-    L.line = nil
+    local S = state(bufnr)
+    S.line = nil
+    if S.cache then
+        chc.save(S.cache)
+    end
 end
 
 --- Wrote buffer
@@ -354,6 +605,20 @@ function M.after_write(bufnr)
     log.trace("Wrote buffer:", bufnr)
 end
 
+--- Generate code for all relevant nodes of the buffer and invoke callback on the group keys and
+--- groups, as offered by batch mode completion. Snippets are not offered to the completion engine.
+function M.batch(bufnr, callback)
+    log.trace("batch buffer:", bufnr)
+    local S = state(bufnr)
+    get_ast(S, function(symbols)
+        lsp.async(function()
+            local keys, groups = group_snippets(generate_preceding(S, symbols, vim.api.nvim_buf_line_count(bufnr)))
+            log.info("Generated", #keys, "batch group(s)")
+            callback(keys, groups)
+        end)
+    end)
+end
+
 --- Info callback
 function M.info()
     return gen.info()
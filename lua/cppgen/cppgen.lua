@@ -1,18 +1,28 @@
 local log = require('cppgen.log')
 
 local src = require('cppgen.cmpsource')
+local rpl = require('cppgen.replay')
+local bch = require('cppgen.bench')
 
 ---------------------------------------------------------------------------------------------------
 -- Code generation module. Forwards events to the code completion module
 ---------------------------------------------------------------------------------------------------
 local M = {}
 
+---------------------------------------------------------------------------------------------------
+-- Global parameters. Initialized in setup.
+---------------------------------------------------------------------------------------------------
+local G = {}
+
 ---------------------------------------------------------------------------------------------------
 --- Initialization callback
 ---------------------------------------------------------------------------------------------------
 function M.setup(opts)
     log.trace("setup")
+    G.batchmode = opts.batchmode
     src.setup(opts)
+    rpl.setup(opts)
+    bch.setup(opts)
 end
 
 ---------------------------------------------------------------------------------------------------
@@ -47,6 +57,14 @@ function M.after_write(bufnr)
 	src.after_write(bufnr)
 end
 
+---------------------------------------------------------------------------------------------------
+--- Callback invoked when the buffer has been wiped out
+---------------------------------------------------------------------------------------------------
+function M.wiped(bufnr)
+    log.trace("Wiped buffer:", bufnr)
+	src.wiped(bufnr)
+end
+
 ---------------------------------------------------------------------------------------------------
 --- Code generator is a source for the completion engine
 ---------------------------------------------------------------------------------------------------
@@ -94,12 +112,83 @@ local function show_info()
     end
 end
 
+-- Start recording responses for the current buffer, or stop and save the fixture
+local function toggle_record()
+    if rpl.recording() then
+        local path = rpl.stop()
+        vim.api.nvim_echo({ { path and ('Saved fixture ' .. path) or 'Fixture was not saved', 'Normal' } }, false, {})
+    else
+        rpl.start(vim.api.nvim_get_current_buf())
+        vim.api.nvim_echo({ { 'Recording, enter insert mode to capture responses', 'Normal' } }, false, {})
+    end
+end
+
+-- Benchmark generators over recorded fixtures, rewriting the golden files on update
+local function run_bench(mode)
+    local reports, passed = bch.run(mode == 'update')
+    local lines = {}
+    for _, r in ipairs(reports) do
+        table.insert(lines, { ' ' .. r .. '\n', passed and 'Normal' or 'WarningMsg' })
+    end
+    vim.api.nvim_echo(lines, false, {})
+end
+
+-- Append lines after the given line of the buffer, in a single edit. Lines are not unpacked, since the batch
+-- output may exceed the number of values unpack can return.
+local function append(bufnr, row, lines)
+    local line = vim.api.nvim_buf_get_lines(bufnr, row, row + 1, true)[1]
+    local text = { '' }
+    vim.list_extend(text, lines)
+    vim.api.nvim_buf_set_text(bufnr, row, #line, row, #line, text)
+end
+
+-- Insert batch mode code of all groups, or of the given group, below the cursor. Groups with a target file are
+-- appended to its buffer instead. Each buffer gets a single edit, so it is undone in one step.
+local function run_batch(group)
+    local bufnr = vim.api.nvim_get_current_buf()
+    local row   = vim.api.nvim_win_get_cursor(0)[1] - 1
+    local file  = vim.api.nvim_buf_get_name(bufnr)
+    src.batch(bufnr, function(keys, groups)
+        local edits, order = {}, {}
+        for _, k in ipairs(keys) do
+            if group == nil or group == k then
+                local target = G.batchmode.target and G.batchmode.target(k, file)
+                local buf    = bufnr
+                if target then
+                    buf = vim.fn.bufadd(target)
+                    vim.fn.bufload(buf)
+                end
+                if edits[buf] == nil then
+                    edits[buf] = {}
+                    table.insert(order, buf)
+                elseif #edits[buf] > 0 then
+                    table.insert(edits[buf], '')
+                end
+                vim.list_extend(edits[buf], vim.split(table.concat(groups[k], '\n'), '\n', { plain = true }))
+            end
+        end
+
+        local lines = {}
+        for _, buf in ipairs(order) do
+            append(buf, buf == bufnr and row or vim.api.nvim_buf_line_count(buf) - 1, edits[buf])
+            table.insert(lines, { (' Inserted %d line(s) into %s\n'):format(#edits[buf], vim.api.nvim_buf_get_name(buf)), 'Normal' })
+        end
+        if #order == 0 then
+            table.insert(lines, { group and ('No batch code for ' .. group) or 'No batch code', 'WarningMsg' })
+        end
+        vim.api.nvim_echo(lines, false, {})
+    end)
+end
+
 ---------------------------------------------------------------------------------------------------
 -- User commands dispatch table
 ---------------------------------------------------------------------------------------------------
 local calls =
 {
-    info = show_info,
+    info   = show_info,
+    record = toggle_record,
+    bench  = run_bench,
+    batch  = run_batch,
 }
 
 local function get_keys(t)
@@ -114,12 +203,16 @@ vim.api.nvim_create_user_command('CppGen',
     function(opts)
         local f = calls[opts.fargs[1] or 'info']
         if f then
-            f()
+            f(unpack(opts.fargs, 2))
         end
     end,
     {
-        nargs = 1,
+        nargs = '*',
         complete = function(ArgLead, CmdLine, CursorPos)
+            -- Only the command is completed
+            if #vim.split(string.sub(CmdLine, 1, CursorPos), '%s+') > 2 then
+                return {}
+            end
             return get_keys(calls)
         end,
         desc = 'CppGen commands.'
@@ -5,43 +5,132 @@ local ast = require('cppgen.ast')
 -- Collection of code snippet generators. It knows the types of AST nodes that the generators can 
 -- handle and can tell if a given node is relevant for code generation.
 -- Givan an AST node and the scope in which the code is generated, it calls specilized generators
--- to produce code snippets.
+-- registered for the kind of the node to produce code snippets.
 ---------------------------------------------------------------------------------------------------
 
 ---------------------------------------------------------------------------------------------------
--- Local parameters
----------------------------------------------------------------------------------------------------
-local L = {
-    digs = {},
+-- Built-in generators. Each entry names the generator module and tells whether the options enable
+-- any of its snippets. Modules of disabled generators are never loaded.
+---------------------------------------------------------------------------------------------------
+local builtin = {
+    { module = 'cppgen.generators.class',
+      enabled = function(o) return o.class.shift.enabled or o.class.shift.maxsize or o.class.format.enabled end },
+    { module = 'cppgen.generators.enum',
+      enabled = function(o)
+          local c = o.enum.cast
+          return o.enum.to_string.enabled or o.enum.shift.enabled or o.enum.shift.maxsize or o.enum.format.enabled
+              or c.from_string.enabled or c.from_string_no_throw.enabled or c.from_integer.enabled or c.from_integer_no_throw.enabled
+      end },
+    { module = 'cppgen.generators.enumset',
+      enabled = function(o) return o.enum.set.enabled end },
+    { module = 'cppgen.generators.cereal',
+      enabled = function(o) return o.class.cereal.enabled end },
+    { module = 'cppgen.generators.compare',
+      enabled = function(o) return o.class.compare.equal.enabled or o.class.compare.diff.enabled or o.class.compare.hash.enabled end },
+    { module = 'cppgen.generators.columns',
+      enabled = function(o) return o.class.columns.enabled end },
+    { module = 'cppgen.generators.view',
+      enabled = function(o) return o.class.view.enabled end },
+    { module = 'cppgen.generators.dispatch',
+      enabled = function(o) return o.class.dispatch.enabled end },
+    { module = 'cppgen.generators.json',
+      enabled = function(o) return o.class.json.enabled or o.enum.json.enabled end },
+    { module = 'cppgen.generators.parse',
+      enabled = function(o) return o.class.parse.enabled or o.enum.parse.enabled end },
+    { module = 'cppgen.generators.fix',
+      enabled = function(o) return o.class.fix.enabled or o.enum.fix.enabled end },
+    { module = 'cppgen.generators.switch',
+      enabled = function(o) return o.enum.switch.enabled end },
 }
 
 ---------------------------------------------------------------------------------------------------
--- Global parameters for code generation.
--- TODO - populate during configuration
+-- Global parameters. Initialized in setup.
 ---------------------------------------------------------------------------------------------------
 local G = {
-    require('cppgen.generators.class'),
-    require('cppgen.generators.enum'),
-    require('cppgen.generators.cereal'),
-    require('cppgen.generators.json'),
-    require('cppgen.generators.switch')
+    opts    = nil,
+    entries = {},
+}
+
+---------------------------------------------------------------------------------------------------
+-- Local parameters. Loaded generators in registration order, and the same generators indexed by
+-- the kind of nodes they handle. Populated on first use.
+---------------------------------------------------------------------------------------------------
+local L = {
+    loaded = nil,
+    bykind = {},
 }
 
 --- Exported functions
 local M = {}
 
+-- Load and set up a single generator. Module may be given by name or as a table.
+local function load_entry(entry)
+    if entry.enabled and not entry.enabled(G.opts) then
+        log.debug("Skipping disabled generator", entry.module)
+        return
+    end
+    local ok, g = true, entry.module
+    if type(g) == 'string' then
+        ok, g = pcall(require, entry.module)
+    end
+    if not ok then
+        log.error("Unable to load generator", entry.module, g)
+        return
+    end
+    g.setup(G.opts)
+    table.insert(L.loaded, g)
+    for _, k in ipairs(g.digs()) do
+        L.bykind[k] = L.bykind[k] or {}
+        table.insert(L.bykind[k], g)
+    end
+end
+
+-- Return the loaded generators, loading the enabled ones first time around.
+local function generators()
+    if L.loaded == nil then
+        L.loaded = {}
+        L.bykind = {}
+        for _, entry in ipairs(G.entries) do
+            load_entry(entry)
+        end
+        log.info("Loaded", #L.loaded, "generator(s)")
+        log.trace("generators:", vim.tbl_keys(L.bykind))
+    end
+    return L.loaded
+end
+
 ---------------------------------------------------------------------------------------------------
---- Initialization callback. Collect kind of nodes the generators can handle
+--- Initialization callback. Register built-in and user generators. Enabled generators are loaded
+--- on first use, normally when a client attaches to a C++ buffer.
 ---------------------------------------------------------------------------------------------------
 function M.setup(opts)
     log.trace("setup")
-    for _,g in pairs(G) do
-        g.setup(opts)
-        for _, k in ipairs(g.digs()) do
-            L.digs[k] = true
-        end
+    G.opts    = opts
+    G.entries = {}
+    L.loaded  = nil
+    for _, entry in ipairs(builtin) do
+        table.insert(G.entries, entry)
+    end
+    for _, entry in ipairs(opts.generators or {}) do
+        M.register(entry)
+    end
+end
+
+---------------------------------------------------------------------------------------------------
+--- Register a user generator. Entry is a table with the module, either a name or a table
+--- implementing the generator interface, and an optional enabled predicate taking the options.
+--- A module name alone is accepted as well.
+---------------------------------------------------------------------------------------------------
+function M.register(entry)
+    if type(entry) ~= 'table' or entry.module == nil then
+        entry = { module = entry }
+    end
+    log.debug("Registering generator", entry.module)
+    table.insert(G.entries, entry)
+    -- Generators already loaded, load this one right away
+    if L.loaded then
+        load_entry(entry)
     end
-    log.trace("setup:", L.digs)
 end
 
 ---------------------------------------------------------------------------------------------------
@@ -49,34 +138,62 @@ end
 ---------------------------------------------------------------------------------------------------
 function M.attached(client, bufnr)
     log.trace("Attached client", client.id, "buffer", bufnr)
-    for _,g in pairs(G) do
+    for _,g in ipairs(generators()) do
         if g.attached then
             g.attached(client, bufnr)
         end
     end
 end
 
+---------------------------------------------------------------------------------------------------
+--- Buffer wiped out callback. Generators holding per buffer state release it.
+---------------------------------------------------------------------------------------------------
+function M.detached(bufnr)
+    log.trace("Detached buffer", bufnr)
+    for _,g in ipairs(L.loaded or {}) do
+        if g.detached then
+            g.detached(bufnr)
+        end
+    end
+end
+
 ---------------------------------------------------------------------------------------------------
 --- Given a node, possibly a type alias, check if at least one of the generators finds it relevant.
 ---------------------------------------------------------------------------------------------------
 function M.is_relevant(node)
     log.trace("is_relevant:", ast.details(node))
+    generators()
     local aliastype = ast.alias_type(node)
     if aliastype then
-        log.trace("is_relevant:", ast.details(node), L.digs[aliastype.kind])
-        return L.digs[aliastype.kind]
+        log.trace("is_relevant:", ast.details(node), L.bykind[aliastype.kind] ~= nil)
+        return L.bykind[aliastype.kind] ~= nil
     end
-    log.trace("is_relevant:", ast.details(node), L.digs[node.kind])
-    return L.digs[node.kind]
+    log.trace("is_relevant:", ast.details(node), L.bykind[node.kind] ~= nil)
+    return L.bykind[node.kind] ~= nil
 end
 
 ---------------------------------------------------------------------------------------------------
 --- Asynchronously generate code snippets for a node and scope. Callback will get code snippets.
+--- Buffer the node comes from is passed on to generators that make requests, defaults to the
+--- current one.
 ---------------------------------------------------------------------------------------------------
-function M.generate(node, alias, scope, acceptor)
+function M.generate(node, alias, scope, acceptor, bufnr)
     log.trace("generate:", ast.details(node))
-    for _,g in pairs(G) do
-        g.generate(node, alias, scope, acceptor)
+    generators()
+    for _,g in ipairs(L.bykind[node.kind] or {}) do
+        g.generate(node, alias, scope, acceptor, bufnr)
+    end
+end
+
+---------------------------------------------------------------------------------------------------
+--- Generate code snippets that need all relevant nodes at once. Used in batch mode.
+---------------------------------------------------------------------------------------------------
+function M.generate_all(nodes, acceptor)
+    log.trace("generate_all:", #nodes)
+    for _,g in ipairs(generators()) do
+        if g.generate_all then
+            g.generate_all(nodes, acceptor)
+        end
     end
 end
 
@@ -85,7 +202,7 @@ end
 ---------------------------------------------------------------------------------------------------
 function M.info()
     local total = {}
-    for _,g in pairs(G) do
+    for _,g in ipairs(generators()) do
         local items = g.info();
         for _,i in ipairs(items) do
             table.insert(total, i)
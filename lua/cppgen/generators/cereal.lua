@@ -47,7 +47,7 @@ local function class_labels_and_values(node, object)
                 record.label = G.class.cereal.label(ast.name(node), record.field, utl.camelize(record.field))
 
                 -- Null handling checks
-                if G.class.cereal.nullcheck then
+                if G.class.cereal.nullcheck and utl.nullable(ast.type(n), G.nullability) then
                     if (object) then
                         record.nullcheck = G.class.cereal.nullcheck(object .. '.' .. record.field, ast.type(n))
                     else
@@ -158,6 +158,71 @@ local function save_class_snippet(node, alias, specifier, member)
     return lines
 end
 
+---------------------------------------------------------------------------------------------------
+-- Generate binary archive serialization snippet for a class type node. The object representation
+-- is written and read in one call.
+---------------------------------------------------------------------------------------------------
+local function binary_class_snippet(node, alias, specifier, member)
+    log.debug("binary_class_snippet:", ast.details(node))
+
+    P.specifier    = specifier
+    P.attribute    = G.attribute and ' ' .. G.attribute or ''
+    P.classname    = alias and ast.name(alias) or ast.name(node)
+    P.functionname = G.class.cereal.name
+    P.indent       = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local lines    = {}
+
+    local function body()
+        table.insert(lines, apply('{'))
+        table.insert(lines, apply('<indent>static_assert(std::is_trivially_copyable_v<<classname>>, "Binary serialization requires trivially copyable type");'))
+        if member then
+            table.insert(lines, apply('<indent>archive(cereal::binary_data(this, sizeof(*this)));'))
+        else
+            table.insert(lines, apply('<indent>archive(cereal::binary_data(&o, sizeof(o)));'))
+        end
+        table.insert(lines, apply('}'))
+    end
+
+    if member then
+        table.insert(lines, apply('<specifier> <attribute> void <functionname>(Archive& archive) const'))
+    else
+        table.insert(lines, apply('<specifier> <attribute> void <functionname>(Archive& archive, const <classname>& o)'))
+    end
+    body()
+
+    -- Loading function is the mirror image of the saving function
+    if G.class.cereal.name == 'save' then
+        if member then
+            table.insert(lines, apply('<specifier> <attribute> void load(Archive& archive)'))
+        else
+            table.insert(lines, apply('<specifier> <attribute> void load(Archive& archive, <classname>& o)'))
+        end
+        body()
+    end
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+-- Check if the class qualifies for binary archive fast path.
+local function binary_qualifies(node, alias)
+    local binary = G.class.cereal.binary
+    return binary and binary.enabled and binary.qualifies(alias and ast.name(alias) or ast.name(node), ast.is_packed(node))
+end
+
+-- Generate named fields serialization for all archives except the native binary ones, followed by the
+-- binary archive fast path. Portable binary archives keep the named fields since they may swap bytes.
+local function save_class_lines(node, alias, member)
+    if binary_qualifies(node, alias) then
+        local native = 'std::is_same<Archive, cereal::BinaryOutputArchive>::value || std::is_same<Archive, cereal::BinaryInputArchive>::value'
+        local text   = 'template <typename Archive, cereal::traits::DisableIf<' .. native .. '> = cereal::traits::sfinae>'
+        local binary = 'template <typename Archive, cereal::traits::EnableIf<' .. native .. '> = cereal::traits::sfinae>'
+        return utl.combine(save_class_snippet(node, alias, text, member), binary_class_snippet(node, alias, binary, member))
+    end
+    return save_class_snippet(node, alias, 'template <typename Archive>', member)
+end
+
 -- Generate completion items
 local function save_class_items(lines)
     return
@@ -169,12 +234,12 @@ end
 -- Generate serialization function snippet items for a class type node.
 local function save_class_member_items(node, alias)
     log.trace("save_class_member_items:", ast.details(node))
-    return save_class_items(save_class_snippet(node, alias, 'template <typename Archive>', true))
+    return save_class_items(save_class_lines(node, alias, true))
 end
 
 local function save_class_free_items(node, alias)
     log.trace("save_class_free_items:", ast.details(node))
-    return save_class_items(save_class_snippet(node, alias, 'template <typename Archive>', false))
+    return save_class_items(save_class_lines(node, alias, false))
 end
 
 ---------------------------------------------------------------------------------------------------
@@ -236,9 +301,10 @@ end
 ---------------------------------------------------------------------------------------------------
 function M.setup(opts)
     log.trace("setup")
-    G.keepindent = opts.keepindent
-    G.attribute  = opts.attribute
-    G.class      = opts.class
+    G.keepindent  = opts.keepindent
+    G.attribute   = opts.attribute
+    G.class       = opts.class
+    G.nullability = opts.nullability
     log.trace("setup:", G)
 end
 
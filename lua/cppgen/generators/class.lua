@@ -124,6 +124,138 @@ local function shift_free_items(node, alias)
     return shift_items(shift_snippet(node, alias, 'inline'))
 end
 
+-- Generate fixed buffer formatting function for a class type node. Produces the same text as the shift operator.
+local function format_snippet(node, alias, specifier)
+    log.debug("format_snippet:", ast.details(node))
+
+    P.specifier            = specifier
+    P.attribute            = G.attribute and ' ' .. G.attribute or ''
+    P.classname            = alias and ast.name(alias) or ast.name(node)
+    P.functionname         = G.class.format.name
+    P.indent               = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    -- Separator is an expression, we can only merge it with the labels if it is a literal
+    local separator        = utl.literal_text(G.class.shift.separator)
+    local preamble         = G.class.shift.preamble and G.class.shift.preamble(P.classname) or ''
+
+    local records          = labels_and_values(node, 'o')
+    for i, r in ipairs(records) do
+        if i == 1 then
+            r.label = preamble .. r.label
+        elseif separator then
+            r.label = separator .. r.label
+        end
+    end
+    local maxllen, _       = max_lengths(records)
+
+    local lines            = {}
+
+    table.insert(lines, apply('<specifier> <attribute> char* <functionname>(char* out, char* end, const <classname>& o)'))
+    table.insert(lines, apply('{'))
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format off'))
+    end
+
+    if #records == 0 and preamble ~= '' then
+        P.label = preamble
+        table.insert(lines, apply('<indent>out = <functionname>(out, end, "<label>");'))
+    end
+
+    for i, r in ipairs(records) do
+        P.fieldname = r.field
+        P.label     = r.label
+        P.value     = r.value
+        P.labelpad  = string.rep(' ', maxllen - string.len(r.label))
+        if i > 1 and not separator then
+            P.separator = G.class.shift.separator
+            table.insert(lines, apply('<indent>out = <functionname>(out, end, <separator>);'))
+        end
+        table.insert(lines, apply('<indent>out = <functionname>(out, end, "<label>");<labelpad> out = <functionname>(out, end, <value>);'))
+    end
+
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format on'))
+    end
+    table.insert(lines, apply('<indent>return out;'))
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+-- Generate completion items for the formatting function.
+local function format_items(lines)
+    return
+    {
+        { name = G.class.format.name, trigger = G.class.format.trigger, lines = lines }
+    }
+end
+
+-- Generate formatting member function completion item for a class type node.
+local function format_member_items(node, alias)
+    log.trace("format_member_items:", ast.details(node))
+    return format_items(format_snippet(node, alias, 'friend'))
+end
+
+-- Generate formatting free function completion item for a class type node.
+local function format_free_items(node, alias)
+    log.trace("format_free_items:", ast.details(node))
+    return format_items(format_snippet(node, alias, 'inline'))
+end
+
+-- Generate maximum text size function for a class type node. Counts the same text as the shift operator.
+local function max_size_snippet(node, alias, specifier)
+    log.debug("max_size_snippet:", ast.details(node))
+
+    P.specifier            = specifier
+    P.attribute            = G.attribute and ' ' .. G.attribute or ''
+    P.classname            = alias and ast.name(alias) or ast.name(node)
+    P.indent               = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local records          = labels_and_values(node, 'std::declval<const ' .. P.classname .. '&>()')
+    local preamble         = G.class.shift.preamble and G.class.shift.preamble(P.classname) or ''
+    local separator        = utl.literal_size(G.class.shift.separator) or
+                             'max_text_size<decltype(' .. G.class.shift.separator .. ')>()'
+
+    local lines            = {}
+
+    table.insert(lines, apply('<specifier> <attribute> std::size_t max_text_size(const <classname>*)'))
+    table.insert(lines, apply('{'))
+    table.insert(lines, apply('<indent>return ' .. utl.literal_size('"' .. preamble .. '"') .. (#records == 0 and ';' or '')))
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format off'))
+    end
+    local maxslen = 0
+    for _, r in ipairs(records) do
+        r.size  = tostring(utl.literal_size('"' .. r.label .. '"'))
+        maxslen = math.max(maxslen, string.len(r.size))
+    end
+    for i, r in ipairs(records) do
+        P.value    = r.value
+        P.labelpad = string.rep(' ', maxslen - string.len(r.size))
+        if i == #records then
+            table.insert(lines, apply('<indent>+ ' .. r.size .. '<labelpad> + max_text_size<decltype(<value>)>();'))
+        else
+            table.insert(lines, apply('<indent>+ ' .. r.size .. '<labelpad> + max_text_size<decltype(<value>)>() + ' .. separator))
+        end
+    end
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format on'))
+    end
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+-- Generate maximum text size completion items.
+local function max_size_items(lines)
+    return
+    {
+        { name = 'max_text_size', trigger = G.class.shift.trigger, lines = lines }
+    }
+end
+
 ---------------------------------------------------------------------------------------------------
 --- Public interface.
 ---------------------------------------------------------------------------------------------------
@@ -138,7 +270,7 @@ function M.digs()
 end
 
 ---------------------------------------------------------------------------------------------------
--- Generate plain output stream shift operator for a class node.
+-- Generate plain output stream shift operator and formatting function for a class node.
 ---------------------------------------------------------------------------------------------------
 function M.generate(node, alias, scope, acceptor)
     log.trace("generate:", ast.details(node))
@@ -155,6 +287,26 @@ function M.generate(node, alias, scope, acceptor)
             end
         end
     end
+    if G.class.shift.maxsize then
+        if ast.is_class(node) then
+            for _, item in ipairs(max_size_items(max_size_snippet(node, alias, scope == ast.Class and 'friend constexpr' or 'constexpr'))) do
+                acceptor(item)
+            end
+        end
+    end
+    if G.class.format.enabled then
+        if ast.is_class(node) then
+            if scope == ast.Class then
+                for _, item in ipairs(format_member_items(node, alias)) do
+                    acceptor(item)
+                end
+            else
+                for _, item in ipairs(format_free_items(node, alias)) do
+                    acceptor(item)
+                end
+            end
+        end
+    end
 end
 
 ---------------------------------------------------------------------------------------------------
@@ -164,9 +316,16 @@ function M.info()
     log.trace("info")
     local info = {}
 
+    local function combine(name, trigger)
+        return name == trigger and name or name .. ' or ' .. trigger
+    end
+
     if G.class.shift.enabled then
         table.insert(info, { G.class.shift.trigger, "Class output stream shift operator" })
     end
+    if G.class.format.enabled then
+        table.insert(info, { combine(G.class.format.name, G.class.format.trigger), "Class formatting into a fixed size buffer" })
+    end
 
     return info
 end
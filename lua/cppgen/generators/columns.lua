@@ -0,0 +1,254 @@
+local ast = require('cppgen.ast')
+local log = require('cppgen.log')
+local utl = require('cppgen.generators.util')
+
+---------------------------------------------------------------------------------------------------
+-- Struct of arrays column container generator.
+---------------------------------------------------------------------------------------------------
+
+---------------------------------------------------------------------------------------------------
+-- Global parameters for code generation. Initialized in setup.
+---------------------------------------------------------------------------------------------------
+local G = {}
+
+---------------------------------------------------------------------------------------------------
+-- Private parameters for code generation.
+---------------------------------------------------------------------------------------------------
+local P = {}
+
+-- Apply parameters to the format string
+local function apply(format)
+    format = string.gsub(format, "<columnsname>", P.columnsname or '')
+    format = string.gsub(format, "<type>", P.type or '')
+    format = string.gsub(format, "<extent>", P.extent or '')
+    format = string.gsub(format, "<first>", P.first or '')
+
+    return utl.apply(P, format)
+end
+
+-- Calculate the longest length of field names
+local function max_length(records)
+    local max_fld_len = 0
+    for _, r in ipairs(records) do
+        max_fld_len = math.max(max_fld_len, string.len(r.field))
+    end
+    return max_fld_len
+end
+
+-- Calculate the longest length of column element types
+local function max_element_length(records)
+    local max_elm_len = 0
+    for _, r in ipairs(records) do
+        max_elm_len = math.max(max_elm_len, string.len(r.element))
+    end
+    return max_elm_len
+end
+
+-- Collect field names for a class type node. Members of unnamed unions share storage and can not
+-- be stored as separate columns, so indirect fields are skipped. C arrays are stored flattened,
+-- with their rank, and booleans are stored as bytes, since std::vector<bool> packs bits.
+local function fields(node)
+    local records = {}
+    ast.visit_children(node,
+        function(n)
+            if not ast.anonymous(n) and n.kind == "Field" then
+                local record   = { field = ast.name(n), type = ast.type(n) or '' }
+                local element  = string.match(record.type, '^([^%(]-)%s*%[')
+                local scalar   = string.gsub(string.gsub(element or record.type, '^const ', ''), '^volatile ', '')
+                if element then
+                    local _, rank = string.gsub(record.type, '%[', '')
+                    record.rank   = rank
+                end
+                record.bool = scalar == 'bool'
+                table.insert(records, record)
+            end
+            return true
+        end
+    )
+    return records
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate column container for a class type node. Each field is stored in its own contiguous
+-- vector, so scans over a few fields do not drag the whole record through the cache.
+---------------------------------------------------------------------------------------------------
+local function columns_snippet(node, alias)
+    log.debug("columns_snippet:", ast.details(node))
+
+    P.attribute   = G.attribute and ' ' .. G.attribute or ''
+    P.classname   = alias and ast.name(alias) or ast.name(node)
+    P.columnsname = G.class.columns.name(P.classname)
+    P.indent      = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local records = fields(node)
+    local maxflen = max_length(records)
+    local lines   = {}
+
+    for _, r in ipairs(records) do
+        if r.bool then
+            r.element = 'std::uint8_t'
+        elseif r.rank then
+            r.element = 'std::remove_all_extents_t<decltype(' .. P.classname .. '::' .. r.field .. ')>'
+        else
+            r.element = 'decltype(' .. P.classname .. '::' .. r.field .. ')'
+        end
+        -- Flattened C array element count, and the first element of the object field
+        if r.rank then
+            r.extent = r.field .. '_extent'
+            r.first  = '&o.' .. r.field .. string.rep('[0]', r.rank)
+        end
+    end
+    local maxelen = max_element_length(records)
+
+    -- Emit one line per field using the given format, or the array format for C array fields
+    local function each(format, array)
+        if G.keepindent then
+            table.insert(lines, apply('<indent><indent>// clang-format off'))
+        end
+        for _, r in ipairs(records) do
+            P.fieldname = r.field
+            P.valuepad  = string.rep(' ', maxflen - string.len(r.field))
+            P.extent    = r.extent
+            P.first     = r.first
+            table.insert(lines, apply(r.rank and array or format))
+        end
+        if G.keepindent then
+            table.insert(lines, apply('<indent><indent>// clang-format on'))
+        end
+    end
+
+    table.insert(lines, apply('struct <attribute> <columnsname>'))
+    table.insert(lines, apply('{'))
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format off'))
+    end
+    for _, r in ipairs(records) do
+        P.fieldname = r.field
+        P.type      = r.element
+        P.labelpad  = string.rep(' ', maxelen - string.len(r.element))
+        table.insert(lines, apply('<indent>std::vector<<type>><labelpad> <fieldname>;'))
+    end
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format on'))
+    end
+    local arrays = {}
+    for _, r in ipairs(records) do
+        if r.rank then
+            table.insert(arrays, r)
+        end
+    end
+    if #arrays > 0 then
+        table.insert(lines, apply(''))
+        if G.keepindent then
+            table.insert(lines, apply('<indent>// clang-format off'))
+        end
+        for _, r in ipairs(arrays) do
+            P.fieldname = r.field
+            P.type      = 'std::remove_all_extents_t<decltype(' .. P.classname .. '::' .. r.field .. ')>'
+            P.extent    = r.extent
+            P.valuepad  = string.rep(' ', maxflen - string.len(r.field))
+            table.insert(lines, apply('<indent>static constexpr std::size_t <extent><valuepad> = sizeof(<classname>::<fieldname>) / sizeof(<type>);'))
+        end
+        if G.keepindent then
+            table.insert(lines, apply('<indent>// clang-format on'))
+        end
+    end
+
+    if #records > 0 then
+        -- Prefer a column holding one element per row
+        local first = records[1]
+        for i = #records, 1, -1 do
+            if records[i].rank == nil then
+                first = records[i]
+            end
+        end
+        P.fieldname = first.field
+        table.insert(lines, apply(''))
+        if first.rank then
+            P.extent = first.extent
+            table.insert(lines, apply('<indent>std::size_t size() const { return <fieldname>.size() / <extent>; }'))
+        else
+            table.insert(lines, apply('<indent>std::size_t size() const { return <fieldname>.size(); }'))
+        end
+        table.insert(lines, apply('<indent>bool empty() const { return <fieldname>.empty(); }'))
+    end
+
+    table.insert(lines, apply(''))
+    table.insert(lines, apply('<indent>void reserve(std::size_t n)'))
+    table.insert(lines, apply('<indent>{'))
+    each('<indent><indent><fieldname>.reserve(n);', '<indent><indent><fieldname>.reserve(n * <extent>);')
+    table.insert(lines, apply('<indent>}'))
+
+    table.insert(lines, apply('<indent>void clear()'))
+    table.insert(lines, apply('<indent>{'))
+    each('<indent><indent><fieldname>.clear();')
+    table.insert(lines, apply('<indent>}'))
+
+    table.insert(lines, apply('<indent>void push_back(const <classname>& o)'))
+    table.insert(lines, apply('<indent>{'))
+    each('<indent><indent><fieldname>.push_back(o.<fieldname>);', '<indent><indent><fieldname>.insert(<fieldname>.end(), <first>, <first> + <extent>);')
+    table.insert(lines, apply('<indent>}'))
+
+    table.insert(lines, apply('<indent><classname> operator[](std::size_t i) const'))
+    table.insert(lines, apply('<indent>{'))
+    table.insert(lines, apply('<indent><indent><classname> o;'))
+    each('<indent><indent>o.<fieldname><valuepad> = <fieldname>[i];', '<indent><indent>std::copy_n(<fieldname>.begin() + i * <extent>, <extent>, <first>);')
+    table.insert(lines, apply('<indent><indent>return o;'))
+    table.insert(lines, apply('<indent>}'))
+    table.insert(lines, apply('};'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+---------------------------------------------------------------------------------------------------
+--- Public interface.
+---------------------------------------------------------------------------------------------------
+local M = {}
+
+---------------------------------------------------------------------------------------------------
+--- Generator will call this method to get kind of nodes that are of interest to each generator.
+---------------------------------------------------------------------------------------------------
+function M.digs()
+    log.trace("digs:")
+    return { "CXXRecord" }
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate completion items. The container refers to the class members, so it is only generated
+-- outside of the class.
+---------------------------------------------------------------------------------------------------
+function M.generate(node, alias, scope, acceptor)
+    log.trace("generate:", ast.details(node))
+
+    if G.class.columns.enabled and scope ~= ast.Class and ast.is_class(node) and not ast.is_class_template(node) then
+        acceptor({ name = G.class.columns.name(alias and ast.name(alias) or ast.name(node)), trigger = G.class.columns.trigger, lines = columns_snippet(node, alias) })
+    end
+end
+
+---------------------------------------------------------------------------------------------------
+--- Info callback
+---------------------------------------------------------------------------------------------------
+function M.info()
+    log.trace("info")
+    local info = {}
+
+    if G.class.columns.enabled then
+        table.insert(info, { G.class.columns.trigger, "Class struct of arrays column container" })
+    end
+
+    return info
+end
+
+---------------------------------------------------------------------------------------------------
+--- Initialization callback. Capture relevant parts of the configuration.
+---------------------------------------------------------------------------------------------------
+function M.setup(opts)
+    log.trace("setup")
+    G.keepindent = opts.keepindent
+    G.attribute  = opts.attribute
+    G.class      = opts.class
+    log.trace("setup:", G)
+end
+
+return M
@@ -0,0 +1,291 @@
+local ast = require('cppgen.ast')
+local log = require('cppgen.log')
+local utl = require('cppgen.generators.util')
+
+---------------------------------------------------------------------------------------------------
+-- Field-wise comparison and hashing function generators.
+---------------------------------------------------------------------------------------------------
+
+---------------------------------------------------------------------------------------------------
+-- Global parameters for code generation. Initialized in setup.
+---------------------------------------------------------------------------------------------------
+local G = {}
+
+---------------------------------------------------------------------------------------------------
+-- Private parameters for code generation.
+---------------------------------------------------------------------------------------------------
+local P = {}
+
+-- Apply parameters to the format string
+local function apply(format)
+    format = string.gsub(format, "<masktype>", P.masktype or '')
+    format = string.gsub(format, "<bit>", P.bit or '')
+
+    return utl.apply(P, format)
+end
+
+-- Calculate the longest length of field names and values
+local function max_lengths(records)
+    local max_fld_len = 0
+    local max_val_len = 0
+
+    for _, r in ipairs(records) do
+        max_fld_len = math.max(max_fld_len, string.len(r.field))
+        max_val_len = math.max(max_val_len, string.len(r.value))
+    end
+    return max_fld_len, max_val_len
+end
+
+-- Collect names and hash values for a class type node. Members of unnamed unions are skipped, since
+-- only one of them is active.
+local function fields_and_values(node, object)
+    local records = {}
+    ast.visit_children(node,
+        function(n)
+            if not ast.anonymous(n) and n.kind == "Field" then
+                local record = {}
+                record.field = ast.name(n)
+                record.value = G.class.compare.hash.value(object .. '.' .. record.field, ast.type(n))
+                table.insert(records, record)
+            end
+            return true
+        end
+    )
+    return records
+end
+
+-- Check if the object representation of the class can be compared and hashed directly.
+local function bytewise(node, alias)
+    return G.class.compare.bytewise(alias and ast.name(alias) or ast.name(node), ast.is_packed(node))
+end
+
+-- Set common parameters
+local function prepare(node, alias, specifier)
+    P.specifier = specifier
+    P.attribute = G.attribute and ' ' .. G.attribute or ''
+    P.classname = alias and ast.name(alias) or ast.name(node)
+    P.indent    = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate equality and inequality operators for a class type node.
+---------------------------------------------------------------------------------------------------
+local function equal_snippet(node, alias, specifier)
+    log.debug("equal_snippet:", ast.details(node))
+    prepare(node, alias, specifier)
+
+    local records     = fields_and_values(node, 'a')
+    local maxflen, _  = max_lengths(records)
+
+    local lines       = {}
+
+    table.insert(lines, apply('<specifier> <attribute> bool operator==(const <classname>& a, const <classname>& b)'))
+    table.insert(lines, apply('{'))
+    if bytewise(node, alias) then
+        table.insert(lines, apply('<indent>static_assert(std::has_unique_object_representations_v<<classname>>, "Bytewise comparison requires unique object representation");'))
+        table.insert(lines, apply('<indent>return std::memcmp(&a, &b, sizeof(a)) == 0;'))
+    elseif #records == 0 then
+        table.insert(lines, apply('<indent>return true;'))
+    else
+        if G.keepindent then
+            table.insert(lines, apply('<indent>// clang-format off'))
+        end
+        for i, r in ipairs(records) do
+            P.fieldname = r.field
+            P.valuepad  = string.rep(' ', maxflen - string.len(r.field))
+            if i == 1 then
+                table.insert(lines, apply('<indent>return a.<fieldname><valuepad> == b.<fieldname>' .. (i == #records and ';' or '')))
+            else
+                table.insert(lines, apply('<indent>    && a.<fieldname><valuepad> == b.<fieldname>' .. (i == #records and ';' or '')))
+            end
+        end
+        if G.keepindent then
+            table.insert(lines, apply('<indent>// clang-format on'))
+        end
+    end
+    table.insert(lines, apply('}'))
+
+    table.insert(lines, apply('<specifier> <attribute> bool operator!=(const <classname>& a, const <classname>& b)'))
+    table.insert(lines, apply('{'))
+    table.insert(lines, apply('<indent>return !(a == b);'))
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate field difference function for a class type node. Bit N of the result is set when
+-- the N-th field differs.
+---------------------------------------------------------------------------------------------------
+local function diff_snippet(node, alias, specifier)
+    log.debug("diff_snippet:", ast.details(node))
+    prepare(node, alias, specifier)
+
+    local records     = fields_and_values(node, 'a')
+    local maxflen, _  = max_lengths(records)
+
+    P.functionname    = G.class.compare.diff.name
+    P.masktype        = #records <= 32 and 'std::uint32_t' or (#records <= 64 and 'std::uint64_t' or 'std::bitset<' .. #records .. '>')
+
+    local packed      = bytewise(node, alias)
+    local lines       = {}
+
+    table.insert(lines, apply('<specifier> <attribute> <masktype> <functionname>(const <classname>& a, const <classname>& b)'))
+    table.insert(lines, apply('{'))
+    table.insert(lines, apply('<indent><masktype> m = 0;'))
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format off'))
+    end
+    for i, r in ipairs(records) do
+        P.fieldname = r.field
+        P.valuepad  = string.rep(' ', maxflen - string.len(r.field))
+        P.bit       = tostring(i - 1)
+        local differs = packed and 'std::memcmp(&a.<fieldname>,<valuepad> &b.<fieldname>,<valuepad> sizeof(a.<fieldname>))<valuepad> != 0'
+                                or '!(a.<fieldname><valuepad> == b.<fieldname><valuepad>)'
+        if #records > 64 then
+            table.insert(lines, apply('<indent>m.set(<bit>, ' .. differs .. ');'))
+        else
+            table.insert(lines, apply('<indent>m |= <masktype>(' .. differs .. ') << <bit>;'))
+        end
+    end
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format on'))
+    end
+    table.insert(lines, apply('<indent>return m;'))
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate hash function for a class type node. Field hashes, or words of the object
+-- representation, are combined using multiply and xor-shift mixing.
+---------------------------------------------------------------------------------------------------
+local function hash_snippet(node, alias, specifier)
+    log.debug("hash_snippet:", ast.details(node))
+    prepare(node, alias, specifier)
+
+    local records     = fields_and_values(node, 'o')
+    local _, maxvlen  = max_lengths(records)
+
+    P.functionname    = G.class.compare.hash.name
+
+    local lines       = {}
+
+    table.insert(lines, apply('<specifier> <attribute> std::size_t <functionname>(const <classname>& o)'))
+    table.insert(lines, apply('{'))
+    table.insert(lines, apply('<indent>std::uint64_t h = 0xcbf29ce484222325;'))
+    if bytewise(node, alias) then
+        table.insert(lines, apply('<indent>static_assert(std::has_unique_object_representations_v<<classname>>, "Bytewise hashing requires unique object representation");'))
+        table.insert(lines, apply('<indent>const auto* p = reinterpret_cast<const unsigned char*>(&o);'))
+        table.insert(lines, apply('<indent>std::size_t i = 0;'))
+        table.insert(lines, apply('<indent>for (; i + sizeof(std::uint64_t) <= sizeof(o); i += sizeof(std::uint64_t)) {'))
+        table.insert(lines, apply('<indent><indent>std::uint64_t w;'))
+        table.insert(lines, apply('<indent><indent>std::memcpy(&w, p + i, sizeof(w));'))
+        table.insert(lines, apply('<indent><indent>h = (h ^ w) * 0x100000001b3;'))
+        table.insert(lines, apply('<indent>}'))
+        table.insert(lines, apply('<indent>for (; i < sizeof(o); ++i) {'))
+        table.insert(lines, apply('<indent><indent>h = (h ^ p[i]) * 0x100000001b3;'))
+        table.insert(lines, apply('<indent>}'))
+    else
+        if G.keepindent then
+            table.insert(lines, apply('<indent>// clang-format off'))
+        end
+        for _, r in ipairs(records) do
+            P.value    = r.value
+            P.valuepad = string.rep(' ', maxvlen - string.len(r.value))
+            table.insert(lines, apply('<indent>h = (h ^ static_cast<std::uint64_t>(<value>))<valuepad> * 0x100000001b3;'))
+        end
+        if G.keepindent then
+            table.insert(lines, apply('<indent>// clang-format on'))
+        end
+    end
+    table.insert(lines, apply('<indent>h ^= h >> 33;'))
+    table.insert(lines, apply('<indent>h *= 0xff51afd7ed558ccd;'))
+    table.insert(lines, apply('<indent>h ^= h >> 33;'))
+    table.insert(lines, apply('<indent>return static_cast<std::size_t>(h);'))
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+-- Generate completion items for all enabled functions.
+local function compare_items(node, alias, specifier)
+    local items = {}
+    if G.class.compare.equal.enabled then
+        table.insert(items, { name = 'operator==', trigger = G.class.compare.equal.trigger, lines = equal_snippet(node, alias, specifier) })
+    end
+    if G.class.compare.diff.enabled then
+        table.insert(items, { name = G.class.compare.diff.name, trigger = G.class.compare.diff.trigger, lines = diff_snippet(node, alias, specifier) })
+    end
+    if G.class.compare.hash.enabled then
+        table.insert(items, { name = G.class.compare.hash.name, trigger = G.class.compare.hash.trigger, lines = hash_snippet(node, alias, specifier) })
+    end
+    return items
+end
+
+---------------------------------------------------------------------------------------------------
+--- Public interface.
+---------------------------------------------------------------------------------------------------
+local M = {}
+
+---------------------------------------------------------------------------------------------------
+--- Generator will call this method to get kind of nodes that are of interest to each generator.
+---------------------------------------------------------------------------------------------------
+function M.digs()
+    log.trace("digs:")
+    return { "CXXRecord", "ClassTemplate" }
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate completion items
+---------------------------------------------------------------------------------------------------
+function M.generate(node, alias, scope, acceptor)
+    log.trace("generate:", ast.details(node))
+
+    if ast.is_class(node) then
+        for _, item in ipairs(compare_items(node, alias, scope == ast.Class and 'friend' or 'inline')) do
+            acceptor(item)
+        end
+    end
+end
+
+---------------------------------------------------------------------------------------------------
+--- Info callback
+---------------------------------------------------------------------------------------------------
+function M.info()
+    log.trace("info")
+    local info = {}
+
+    local function combine(name, trigger)
+        return name == trigger and name or name .. ' or ' .. trigger
+    end
+
+    if G.class.compare.equal.enabled then
+        table.insert(info, { G.class.compare.equal.trigger, "Class field-wise equality operators" })
+    end
+    if G.class.compare.diff.enabled then
+        table.insert(info, { combine(G.class.compare.diff.name, G.class.compare.diff.trigger), "Class field difference bit mask" })
+    end
+    if G.class.compare.hash.enabled then
+        table.insert(info, { combine(G.class.compare.hash.name, G.class.compare.hash.trigger), "Class hash function" })
+    end
+
+    return info
+end
+
+---------------------------------------------------------------------------------------------------
+--- Initialization callback. Capture relevant parts of the configuration.
+---------------------------------------------------------------------------------------------------
+function M.setup(opts)
+    log.trace("setup")
+    G.keepindent = opts.keepindent
+    G.attribute  = opts.attribute
+    G.class      = opts.class
+    log.trace("setup:", G)
+end
+
+return M
@@ -0,0 +1,193 @@
+local ast = require('cppgen.ast')
+local log = require('cppgen.log')
+local utl = require('cppgen.generators.util')
+
+---------------------------------------------------------------------------------------------------
+-- Message dispatcher generator. Unlike other generators it looks at all message classes in the
+-- file at once and emits a single function that routes raw bytes to the message type selected by
+-- the header discriminator.
+---------------------------------------------------------------------------------------------------
+
+---------------------------------------------------------------------------------------------------
+-- Global parameters for code generation. Initialized in setup.
+---------------------------------------------------------------------------------------------------
+local G = {}
+
+---------------------------------------------------------------------------------------------------
+-- Private parameters for code generation.
+---------------------------------------------------------------------------------------------------
+local P = {}
+
+-- Apply parameters to the format string
+local function apply(format)
+    format = string.gsub(format, "<header>", P.header or '')
+    format = string.gsub(format, "<discriminator>", P.discriminator or '')
+    format = string.gsub(format, "<size>", P.size or '')
+
+    return utl.apply(P, format)
+end
+
+-- Check if the class node declares an enumerator named as the discriminator, for example
+-- enum : std::uint8_t { type = 'D' };
+local function has_discriminator(node)
+    local found = false
+    ast.visit_children(node,
+        function(n)
+            if n.kind == "Enum" then
+                ast.visit_children(n,
+                    function(c)
+                        found = c.kind == "EnumConstant" and ast.name(c) == G.class.dispatch.discriminator
+                        return not found
+                    end
+                )
+            end
+            return not found
+        end
+    )
+    return found
+end
+
+-- Check if the class node has a field of the header type
+local function has_header(node)
+    return ast.count_children(node, function(n)
+        return n.kind == "Field" and ast.type(n) == G.class.dispatch.header
+    end) > 0
+end
+
+-- Collect names of message classes, in order of appearance and without duplicates.
+local function message_classes(nodes)
+    local names = {}
+    local seen  = {}
+    for _, node in ipairs(nodes) do
+        local name = ast.name(node)
+        if ast.is_class(node) and not ast.is_class_template(node) and not seen[name] and has_header(node) and has_discriminator(node) then
+            seen[name] = true
+            table.insert(names, name)
+        end
+    end
+    return names
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate dispatch function for message classes. The visitor is called with a reference to the
+-- message overlaid on the buffer, once the message size given by the header and the buffer size are
+-- both validated against the size of the message.
+---------------------------------------------------------------------------------------------------
+local function dispatch_snippet(names)
+    log.debug("dispatch_snippet:", names)
+
+    P.attribute     = G.attribute and ' ' .. G.attribute or ''
+    P.functionname  = G.class.dispatch.name
+    P.header        = G.class.dispatch.header
+    P.discriminator = G.class.dispatch.discriminator
+    P.size          = G.class.dispatch.size('header')
+    P.indent        = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local maxlen = 0
+    for _, n in ipairs(names) do
+        maxlen = math.max(maxlen, string.len(n))
+    end
+
+    local lines = {}
+
+    table.insert(lines, apply('template<typename Visitor>'))
+    table.insert(lines, apply('inline <attribute> bool <functionname>(const char* data, std::size_t size, Visitor&& visitor)'))
+    table.insert(lines, apply('{'))
+    table.insert(lines, apply('<indent>if (size < sizeof(<header>)) {'))
+    table.insert(lines, apply('<indent><indent>return false;'))
+    table.insert(lines, apply('<indent>}'))
+    table.insert(lines, apply('<indent><header> header;'))
+    table.insert(lines, apply('<indent>std::memcpy(&header, data, sizeof(header));'))
+    table.insert(lines, apply(''))
+    table.insert(lines, apply('<indent>auto accept = [&](auto* tag) {'))
+    table.insert(lines, apply('<indent><indent>using T = std::remove_pointer_t<decltype(tag)>;'))
+    table.insert(lines, apply('<indent><indent>static_assert(alignof(T) == 1, "Dispatched messages must be packed");'))
+    table.insert(lines, apply('<indent><indent>if (<size> != T::size() || size < T::size()) {'))
+    table.insert(lines, apply('<indent><indent><indent>return false;'))
+    table.insert(lines, apply('<indent><indent>}'))
+    table.insert(lines, apply('<indent><indent>visitor(*reinterpret_cast<const T*>(data));'))
+    table.insert(lines, apply('<indent><indent>return true;'))
+    table.insert(lines, apply('<indent>};'))
+    table.insert(lines, apply(''))
+    table.insert(lines, apply('<indent>switch (header.<discriminator>)'))
+    table.insert(lines, apply('<indent>{'))
+    if G.keepindent then
+        table.insert(lines, apply('<indent><indent>// clang-format off'))
+    end
+    for _, n in ipairs(names) do
+        P.classname = n
+        P.valuepad  = string.rep(' ', maxlen - string.len(n))
+        table.insert(lines, apply('<indent><indent>case <classname>::<discriminator>:<valuepad> return accept(static_cast<<classname>*>(nullptr));'))
+    end
+    table.insert(lines, apply('<indent><indent>default: return false;'))
+    if G.keepindent then
+        table.insert(lines, apply('<indent><indent>// clang-format on'))
+    end
+    table.insert(lines, apply('<indent>}'))
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+---------------------------------------------------------------------------------------------------
+--- Public interface.
+---------------------------------------------------------------------------------------------------
+local M = {}
+
+---------------------------------------------------------------------------------------------------
+--- Generator will call this method to get kind of nodes that are of interest to each generator.
+---------------------------------------------------------------------------------------------------
+function M.digs()
+    log.trace("digs:")
+    return { "CXXRecord" }
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate completion items for a single node. Dispatcher needs all message classes, see generate_all.
+---------------------------------------------------------------------------------------------------
+function M.generate(node, alias, scope, acceptor)
+    log.trace("generate:", ast.details(node))
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate completion items from all relevant nodes in the file.
+---------------------------------------------------------------------------------------------------
+function M.generate_all(nodes, acceptor)
+    log.trace("generate_all:", #nodes)
+
+    if G.class.dispatch.enabled then
+        local names = message_classes(nodes)
+        if #names > 0 then
+            acceptor({ name = G.class.dispatch.name, trigger = G.class.dispatch.trigger, lines = dispatch_snippet(names) })
+        end
+    end
+end
+
+---------------------------------------------------------------------------------------------------
+--- Info callback
+---------------------------------------------------------------------------------------------------
+function M.info()
+    log.trace("info")
+    local info = {}
+
+    if G.class.dispatch.enabled then
+        local name, trigger = G.class.dispatch.name, G.class.dispatch.trigger
+        table.insert(info, { name == trigger and name or name .. ' or ' .. trigger, "Message dispatcher on header discriminator (batch mode)" })
+    end
+
+    return info
+end
+
+---------------------------------------------------------------------------------------------------
+--- Initialization callback. Capture relevant parts of the configuration.
+---------------------------------------------------------------------------------------------------
+function M.setup(opts)
+    log.trace("setup")
+    G.keepindent = opts.keepindent
+    G.attribute  = opts.attribute
+    G.class      = opts.class
+    log.trace("setup:", G)
+end
+
+return M
@@ -22,6 +22,8 @@ local function apply(format)
     format = string.gsub(format, "<error>", P.error or '')
     format = string.gsub(format, "<exception>", P.exception or '')
     format = string.gsub(format, "<default>", P.default or '')
+    format = string.gsub(format, "<string>", P.string or '')
+    format = string.gsub(format, "<resource>", P.resource or '')
 
     return utl.apply(P, format)
 end
@@ -39,7 +41,7 @@ local function labels_and_values(node, alias, vf)
             table.insert(lsandvs, record)
         end
     end
-    return lsandvs
+    return utl.by_frequency(lsandvs, G.profile)
 end
 
 -- Calculate the longest length of labels and values
@@ -59,12 +61,15 @@ local function max_lengths(records)
 end
 
 ---------------------------------------------------------------------------------------------------
--- Generate to string converter.
+-- Generate to string converter. The allocator aware variant returns strings allocated from the
+-- memory resource passed as the last parameter.
 ---------------------------------------------------------------------------------------------------
-local function to_string_snippet(node, alias, specifier)
+local function to_string_snippet(node, alias, specifier, pmr)
     log.trace("to_string_snippet:", ast.details(node))
 
     P.specifier            = specifier
+    P.string               = pmr and 'std::pmr::string' or 'std::string'
+    P.resource             = pmr and ', std::pmr::memory_resource* mr' or ''
     P.attribute            = G.attribute and ' ' .. G.attribute or ''
     P.classname            = alias and ast.name(alias) or ast.name(node)
     P.functionname         = G.enum.to_string.name
@@ -75,7 +80,7 @@ local function to_string_snippet(node, alias, specifier)
 
     local lines            = {}
 
-    table.insert(lines, apply('<specifier> <attribute> std::string <functionname>(<classname> o)'))
+    table.insert(lines, apply('<specifier> <attribute> <string> <functionname>(<classname> o<resource>)'))
     table.insert(lines, apply('{'))
     table.insert(lines, apply('<indent>switch(o)'))
     table.insert(lines, apply('<indent>{'))
@@ -85,15 +90,17 @@ local function to_string_snippet(node, alias, specifier)
 
     for _, r in ipairs(records) do
         P.label    = r.label
-        P.value    = r.value
+        P.value    = pmr and 'std::pmr::string(' .. r.value .. ', mr)' or r.value
         P.labelpad = string.rep(' ', maxllen - string.len(r.label))
         P.valuepad = string.rep(' ', maxvlen - string.len(r.value))
-        table.insert(lines, apply('<indent><indent>case <label>:<labelpad> return <value>;<valuepad> break;'))
+        P.likely   = utl.likely(r, G.profile)
+        table.insert(lines, apply('<indent><indent>case <label>:<labelpad> <likely>return <value>;<valuepad> break;'))
     end
 
     if G.enum.to_string.default then
         P.default = G.enum.to_string.default(P.classname, 'o')
         if P.default then
+            P.default = pmr and 'std::pmr::string(' .. P.default .. ', mr)' or P.default
             table.insert(lines, apply('<indent><indent>default: return <default>; break;'))
         end
     end
@@ -116,16 +123,25 @@ local function to_string_items(lines)
     }
 end
 
+-- Generate to string converter followed by the allocator aware overload, if enabled.
+local function to_string_snippets(node, alias, specifier)
+    local lines = to_string_snippet(node, alias, specifier, false)
+    if G.pmr.enabled then
+        utl.append(lines, to_string_snippet(node, alias, specifier, true))
+    end
+    return lines
+end
+
 -- Generate to string member function converter completion item for an enum type node.
 local function to_string_member_items(node, alias)
     log.trace("to_string_member_items:", ast.details(node))
-    return to_string_items(to_string_snippet(node, alias, 'friend'))
+    return to_string_items(to_string_snippets(node, alias, 'friend'))
 end
 
 -- Generate to string free function converter completion item for an enum type node.
 local function to_string_free_items(node, alias)
     log.trace("to_string_free_items:", ast.details(node))
-    return to_string_items(to_string_snippet(node, alias, 'inline'))
+    return to_string_items(to_string_snippets(node, alias, 'inline'))
 end
 
 ---------------------------------------------------------------------------------------------------
@@ -187,7 +203,8 @@ local function string_cast_snippets(node, alias, specifier, throw)
         P.value    = r.value
         P.labelpad = string.rep(' ', maxllen - string.len(r.label))
         P.valuepad = string.rep(' ', maxvlen - string.len(r.value))
-        table.insert(spec, apply('<indent>if (v == "<value>")<valuepad> return <label>;'))
+        P.likely   = utl.likely(r, G.profile)
+        table.insert(spec, apply('<indent>if (v == "<value>")<valuepad> <likely>return <label>;'))
     end
 
     if G.keepindent then
@@ -225,7 +242,7 @@ local function integer_cast_snippets(node, alias, specifier, throw)
     P.declaration    = 'template<typename T>'
     P.specialization = 'template<>'
 
-    local records    = utl.enum_records(node)
+    local records    = utl.by_frequency(utl.enum_records(node), G.profile, function(r) return P.classname .. '::' .. r.label end)
     local maxllen, _ = max_lengths(records)
 
     local function declpattern(throwing)
@@ -413,7 +430,8 @@ local function shift_snippet(node, alias, specifier)
             P.value    = r.value
             P.labelpad = string.rep(' ', maxllen - string.len(r.label))
             P.valuepad = string.rep(' ', maxvlen - string.len(r.value))
-            table.insert(lines, apply('<indent><indent>case <label>:<labelpad> s << <value>;<valuepad> break;'))
+            P.likely   = utl.likely(r, G.profile)
+            table.insert(lines, apply('<indent><indent>case <label>:<labelpad> <likely>s << <value>;<valuepad> break;'))
         end
         if G.enum.shift.default then
             P.default = G.enum.shift.default(P.classname, 'o')
@@ -453,6 +471,125 @@ local function shift_free_items(node, alias)
     return shift_items(shift_snippet(node, alias, 'inline'))
 end
 
+---------------------------------------------------------------------------------------------------
+-- Generate maximum text size function. Sizes of literal values are computed here. The default case
+-- is assumed to print the promoted underlying value, possibly with literal text.
+---------------------------------------------------------------------------------------------------
+local function max_size_snippet(node, alias, specifier)
+    log.trace("max_size_snippet:", ast.details(node))
+
+    P.specifier            = specifier
+    P.attribute            = G.attribute and ' ' .. G.attribute or ''
+    P.classname            = alias and ast.name(alias) or ast.name(node)
+    P.indent               = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local literal          = 0
+    local terms            = {}
+    for _, r in ipairs(labels_and_values(node, alias, G.enum.shift.value)) do
+        local size = utl.literal_size(r.value)
+        if size then
+            literal = math.max(literal, size)
+        else
+            table.insert(terms, 'max_text_size<decltype(' .. r.value .. ')>()')
+        end
+    end
+    local default          = G.enum.shift.default and G.enum.shift.default(P.classname, 'o')
+    if default then
+        local size, _ = utl.embedded_literals_size(default)
+        table.insert(terms, size .. ' + max_text_size<decltype(+std::declval<std::underlying_type_t<' .. P.classname .. '>>())>()')
+    end
+
+    local lines            = {}
+
+    table.insert(lines, apply('<specifier> <attribute> std::size_t max_text_size(const <classname>*)'))
+    table.insert(lines, apply('{'))
+    if #terms == 0 then
+        table.insert(lines, apply('<indent>return ' .. literal .. ';'))
+    else
+        table.insert(lines, apply('<indent>return std::max<std::size_t>({ ' .. literal .. ', ' .. table.concat(terms, ', ') .. ' });'))
+    end
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+-- Generate maximum text size completion items.
+local function max_size_items(lines)
+    return
+    {
+        { name = 'max_text_size', trigger = G.enum.shift.trigger, lines = lines }
+    }
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate fixed buffer formatting function. Produces the same text as the shift operator.
+---------------------------------------------------------------------------------------------------
+local function format_snippet(node, alias, specifier)
+    log.trace("format_snippet:", ast.details(node))
+
+    P.specifier            = specifier
+    P.attribute            = G.attribute and ' ' .. G.attribute or ''
+    P.classname            = alias and ast.name(alias) or ast.name(node)
+    P.functionname         = G.enum.format.name
+    P.indent               = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local records          = labels_and_values(node, alias, G.enum.shift.value)
+    local maxllen, _       = max_lengths(records)
+
+    local lines            = {}
+
+    table.insert(lines, apply('<specifier> <attribute> char* <functionname>(char* out, char* end, <classname> o)'))
+    table.insert(lines, apply('{'))
+    table.insert(lines, apply('<indent>switch(o)'))
+    table.insert(lines, apply('<indent>{'))
+    if G.keepindent then
+        table.insert(lines, apply('<indent><indent>// clang-format off'))
+    end
+    for _, r in ipairs(records) do
+        P.label    = r.label
+        P.value    = r.value
+        P.labelpad = string.rep(' ', maxllen - string.len(r.label))
+        P.likely   = utl.likely(r, G.profile)
+        table.insert(lines, apply('<indent><indent>case <label>:<labelpad> <likely>return <functionname>(out, end, <value>);'))
+    end
+    if G.enum.shift.default then
+        P.default = G.enum.shift.default(P.classname, 'o')
+        if P.default then
+            table.insert(lines, apply('<indent><indent>default: return <functionname>(out, end, <default>);'))
+        end
+    end
+    if G.keepindent then
+        table.insert(lines, apply('<indent><indent>// clang-format on'))
+    end
+    table.insert(lines, apply('<indent>};'))
+    table.insert(lines, apply('<indent>return out;'))
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+-- Generate completion items for the formatting function.
+local function format_items(lines)
+    return
+    {
+        { name = G.enum.format.name, trigger = G.enum.format.trigger, lines = lines }
+    }
+end
+
+-- Generate formatting member function completion item for an enum type node.
+local function format_member_items(node, alias)
+    log.trace("format_member_items:", ast.details(node))
+    return format_items(format_snippet(node, alias, 'friend'))
+end
+
+-- Generate formatting free function completion item for an enum type node.
+local function format_free_items(node, alias)
+    log.trace("format_free_items:", ast.details(node))
+    return format_items(format_snippet(node, alias, 'inline'))
+end
+
 ---------------------------------------------------------------------------------------------------
 --- Public interface.
 ---------------------------------------------------------------------------------------------------
@@ -487,6 +624,16 @@ function M.generate(node, alias, scope, acceptor)
                     acceptor(item)
                 end
             end
+            if G.enum.shift.maxsize then
+                for _, item in ipairs(max_size_items(max_size_snippet(node, alias, 'friend constexpr'))) do
+                    acceptor(item)
+                end
+            end
+            if G.enum.format.enabled then
+                for _, item in ipairs(format_member_items(node, alias)) do
+                    acceptor(item)
+                end
+            end
         else
             if G.enum.to_string.enabled then
                 for _, item in ipairs(to_string_free_items(node, alias)) do
@@ -501,6 +648,16 @@ function M.generate(node, alias, scope, acceptor)
                     acceptor(item)
                 end
             end
+            if G.enum.shift.maxsize then
+                for _, item in ipairs(max_size_items(max_size_snippet(node, alias, 'constexpr'))) do
+                    acceptor(item)
+                end
+            end
+            if G.enum.format.enabled then
+                for _, item in ipairs(format_free_items(node, alias)) do
+                    acceptor(item)
+                end
+            end
         end
     end
 end
@@ -535,6 +692,9 @@ function M.info()
     if G.enum.shift.enabled then
         table.insert(info, { G.enum.shift.trigger, "Enum class output stream shift operator" })
     end
+    if G.enum.format.enabled then
+        table.insert(info, { combine(G.enum.format.name, G.enum.format.trigger), "Enum class formatting into a fixed size buffer" })
+    end
 
     return info
 end
@@ -547,6 +707,8 @@ function M.setup(opts)
     G.keepindent = opts.keepindent
     G.attribute  = opts.attribute
     G.enum       = opts.enum
+    G.profile    = opts.profile
+    G.pmr        = opts.pmr
     log.trace("setup:", G)
 end
 
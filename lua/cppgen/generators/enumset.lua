@@ -0,0 +1,324 @@
+local ast = require('cppgen.ast')
+local log = require('cppgen.log')
+local utl = require('cppgen.generators.util')
+
+---------------------------------------------------------------------------------------------------
+-- Bit set backed enumeration set generator.
+---------------------------------------------------------------------------------------------------
+
+---------------------------------------------------------------------------------------------------
+-- Global parameters for code generation. Initialized in setup.
+---------------------------------------------------------------------------------------------------
+local G = {}
+
+---------------------------------------------------------------------------------------------------
+-- Private parameters for code generation.
+---------------------------------------------------------------------------------------------------
+local P = {}
+
+-- Maximum number of enumerators that fit into the storage word
+local CAPACITY = 64
+
+-- Apply parameters to the format string
+local function apply(format)
+    format = string.gsub(format, "<setname>", P.setname or '')
+    format = string.gsub(format, "<capacity>", P.capacity or '')
+    format = string.gsub(format, "<bit>", P.bit or '')
+
+    return utl.apply(P, format)
+end
+
+-- Integer value of an enumerator literal, nil if not known
+local function integer_value(r)
+    if r.kind == "IntegerLiteral" then
+        return tonumber(r.value)
+    end
+    if r.kind == "CharacterLiteral" then
+        local c = string.match(r.value or '', "^'(.)'$")
+        return c and string.byte(c)
+    end
+    return nil
+end
+
+-- Collect distinct enumerators. Values are known for literal initializers and for implicit ones
+-- following a known value. Enumerators referring to a preceding one, or sharing a known value with
+-- it, are aliases and map to the same bit. Returns the records and the lowest value if the values
+-- form a contiguous range, so that the bit can be computed from the value.
+local function enumerators(node, alias)
+    local records  = {}
+    local values   = {}
+    local declared = {}
+    local seen     = {}
+    local known    = true
+    local previous = -1
+    for _, r in ipairs(utl.enum_records(node)) do
+        local v = nil
+        if r.exact then
+            v = integer_value(r)
+        elseif r.implicit then
+            v = previous and previous + 1
+        elseif r.reference then
+            v = values[r.reference]
+        end
+        local aliased = r.reference ~= nil and declared[r.reference] or v ~= nil and seen[v]
+        values[r.label]   = v
+        declared[r.label] = true
+        previous          = v
+
+        if not aliased then
+            if v ~= nil then
+                seen[v] = true
+            end
+            known = known and v ~= nil
+            table.insert(records, { label = (alias and ast.name(alias) or ast.name(node)) .. '::' .. r.label, value = v })
+        end
+    end
+
+    if known and #records > 0 then
+        local min, max = records[1].value, records[1].value
+        for _, r in ipairs(records) do
+            min = math.min(min, r.value)
+            max = math.max(max, r.value)
+        end
+        if max - min + 1 == #records then
+            return records, min
+        end
+    end
+    return records, nil
+end
+
+-- Calculate the longest length of labels
+local function max_length(records)
+    local max_lab_len = 0
+    for _, r in ipairs(records) do
+        max_lab_len = math.max(max_lab_len, string.len(r.label))
+    end
+    return max_lab_len
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate set class template declaration.
+---------------------------------------------------------------------------------------------------
+local function set_decl_snippet()
+    P.setname = G.enum.set.name
+    return { apply('template<typename E> class <setname>;') }
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate set class template specialization for an enum type node. Each enumerator is a bit in
+-- a 64 bit word, so membership is a single and, and set algebra works on whole words.
+---------------------------------------------------------------------------------------------------
+local function set_spec_snippet(node, alias)
+    log.debug("set_spec_snippet:", ast.details(node))
+
+    local records, min = enumerators(node, alias)
+
+    P.attribute = G.attribute and ' ' .. G.attribute or ''
+    P.classname = alias and ast.name(alias) or ast.name(node)
+    P.setname   = G.enum.set.name
+    P.capacity  = tostring(#records)
+    P.indent    = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local maxllen = max_length(records)
+    local lines   = {}
+
+    table.insert(lines, apply('template<>'))
+    table.insert(lines, apply('class <attribute> <setname><<classname>>'))
+    table.insert(lines, apply('{'))
+    table.insert(lines, apply('public:'))
+    table.insert(lines, apply('<indent>using value_type = <classname>;'))
+    table.insert(lines, apply(''))
+    table.insert(lines, apply('<indent>constexpr <setname>() = default;'))
+    table.insert(lines, apply('<indent>constexpr <setname>(std::initializer_list<<classname>> values)'))
+    table.insert(lines, apply('<indent>{'))
+    table.insert(lines, apply('<indent><indent>for (auto v : values) {'))
+    table.insert(lines, apply('<indent><indent><indent>bits_ |= mask(v);'))
+    table.insert(lines, apply('<indent><indent>}'))
+    table.insert(lines, apply('<indent>}'))
+    table.insert(lines, apply(''))
+    table.insert(lines, apply('<indent>static constexpr std::size_t capacity() { return <capacity>; }'))
+    table.insert(lines, apply(''))
+
+    -- Mapping between enumerators and bits
+    if min then
+        P.value = min < 0 and '(' .. tostring(min) .. ')' or tostring(min)
+        table.insert(lines, apply('<indent>static constexpr int bit(<classname> v) { return static_cast<int>(v) - <value>; }'))
+        table.insert(lines, apply('<indent>static constexpr <classname> value(int bit) { return static_cast<<classname>>(bit + <value>); }'))
+    else
+        table.insert(lines, apply('<indent>static constexpr int bit(<classname> v)'))
+        table.insert(lines, apply('<indent>{'))
+        table.insert(lines, apply('<indent><indent>switch (v)'))
+        table.insert(lines, apply('<indent><indent>{'))
+        if G.keepindent then
+            table.insert(lines, apply('<indent><indent><indent>// clang-format off'))
+        end
+        for i, r in ipairs(records) do
+            P.label    = r.label
+            P.labelpad = string.rep(' ', maxllen - string.len(r.label))
+            P.bit      = tostring(i - 1)
+            table.insert(lines, apply('<indent><indent><indent>case <label>:<labelpad> return <bit>;'))
+        end
+        table.insert(lines, apply('<indent><indent><indent>default: return -1;'))
+        if G.keepindent then
+            table.insert(lines, apply('<indent><indent><indent>// clang-format on'))
+        end
+        table.insert(lines, apply('<indent><indent>}'))
+        table.insert(lines, apply('<indent>}'))
+        local labels = {}
+        for _, r in ipairs(records) do
+            table.insert(labels, r.label)
+        end
+        P.value = table.concat(labels, ', ')
+        table.insert(lines, apply('<indent>static constexpr <classname> value(int bit)'))
+        table.insert(lines, apply('<indent>{'))
+        table.insert(lines, apply('<indent><indent>constexpr <classname> values[] = { <value> };'))
+        table.insert(lines, apply('<indent><indent>return values[bit];'))
+        table.insert(lines, apply('<indent>}'))
+    end
+    table.insert(lines, apply(''))
+
+    -- Element access
+    table.insert(lines, apply('<indent>constexpr bool contains(<classname> v) const { return (bits_ & mask(v)) != 0; }'))
+    table.insert(lines, apply('<indent>constexpr bool insert(<classname> v)'))
+    table.insert(lines, apply('<indent>{'))
+    table.insert(lines, apply('<indent><indent>bool inserted = !contains(v);'))
+    table.insert(lines, apply('<indent><indent>bits_ |= mask(v);'))
+    table.insert(lines, apply('<indent><indent>return inserted;'))
+    table.insert(lines, apply('<indent>}'))
+    table.insert(lines, apply('<indent>constexpr bool erase(<classname> v)'))
+    table.insert(lines, apply('<indent>{'))
+    table.insert(lines, apply('<indent><indent>bool erased = contains(v);'))
+    table.insert(lines, apply('<indent><indent>bits_ &= ~mask(v);'))
+    table.insert(lines, apply('<indent><indent>return erased;'))
+    table.insert(lines, apply('<indent>}'))
+    table.insert(lines, apply('<indent>constexpr void clear() { bits_ = 0; }'))
+    table.insert(lines, apply('<indent>constexpr bool empty() const { return bits_ == 0; }'))
+    table.insert(lines, apply('<indent>constexpr std::size_t size() const { return popcount(bits_); }'))
+    table.insert(lines, apply('<indent>constexpr std::uint64_t bits() const { return bits_; }'))
+    table.insert(lines, apply(''))
+
+    -- Set algebra
+    table.insert(lines, apply('<indent>constexpr bool includes(<setname> o) const { return (bits_ & o.bits_) == o.bits_; }'))
+    table.insert(lines, apply('<indent>constexpr <setname>& operator|=(<setname> o) { bits_ |= o.bits_; return *this; }'))
+    table.insert(lines, apply('<indent>constexpr <setname>& operator&=(<setname> o) { bits_ &= o.bits_; return *this; }'))
+    table.insert(lines, apply('<indent>constexpr <setname>& operator^=(<setname> o) { bits_ ^= o.bits_; return *this; }'))
+    table.insert(lines, apply('<indent>constexpr <setname>& operator-=(<setname> o) { bits_ &= ~o.bits_; return *this; }'))
+    table.insert(lines, apply('<indent>friend constexpr <setname> operator|(<setname> a, <setname> b) { return a |= b; }'))
+    table.insert(lines, apply('<indent>friend constexpr <setname> operator&(<setname> a, <setname> b) { return a &= b; }'))
+    table.insert(lines, apply('<indent>friend constexpr <setname> operator^(<setname> a, <setname> b) { return a ^= b; }'))
+    table.insert(lines, apply('<indent>friend constexpr <setname> operator-(<setname> a, <setname> b) { return a -= b; }'))
+    table.insert(lines, apply('<indent>friend constexpr bool operator==(<setname> a, <setname> b) { return a.bits_ == b.bits_; }'))
+    table.insert(lines, apply('<indent>friend constexpr bool operator!=(<setname> a, <setname> b) { return a.bits_ != b.bits_; }'))
+    table.insert(lines, apply(''))
+
+    -- Iteration in bit order, lowest set bit first
+    table.insert(lines, apply('<indent>class iterator'))
+    table.insert(lines, apply('<indent>{'))
+    table.insert(lines, apply('<indent>public:'))
+    table.insert(lines, apply('<indent><indent>using iterator_category = std::forward_iterator_tag;'))
+    table.insert(lines, apply('<indent><indent>using value_type        = <classname>;'))
+    table.insert(lines, apply('<indent><indent>using difference_type   = std::ptrdiff_t;'))
+    table.insert(lines, apply('<indent><indent>using pointer           = const <classname>*;'))
+    table.insert(lines, apply('<indent><indent>using reference         = <classname>;'))
+    table.insert(lines, apply(''))
+    table.insert(lines, apply('<indent><indent>constexpr explicit iterator(std::uint64_t bits = 0) : bits_(bits) {}'))
+    table.insert(lines, apply('<indent><indent>constexpr <classname> operator*() const { return value(countr_zero(bits_)); }'))
+    table.insert(lines, apply('<indent><indent>constexpr iterator& operator++() { bits_ &= bits_ - 1; return *this; }'))
+    table.insert(lines, apply('<indent><indent>constexpr iterator operator++(int) { iterator i = *this; ++*this; return i; }'))
+    table.insert(lines, apply('<indent><indent>friend constexpr bool operator==(iterator a, iterator b) { return a.bits_ == b.bits_; }'))
+    table.insert(lines, apply('<indent><indent>friend constexpr bool operator!=(iterator a, iterator b) { return a.bits_ != b.bits_; }'))
+    table.insert(lines, apply(''))
+    table.insert(lines, apply('<indent>private:'))
+    table.insert(lines, apply('<indent><indent>std::uint64_t bits_;'))
+    table.insert(lines, apply('<indent>};'))
+    table.insert(lines, apply(''))
+    table.insert(lines, apply('<indent>constexpr iterator begin() const { return iterator(bits_); }'))
+    table.insert(lines, apply('<indent>constexpr iterator end() const { return iterator(); }'))
+    table.insert(lines, apply(''))
+
+    table.insert(lines, apply('private:'))
+    table.insert(lines, apply('<indent>static constexpr std::uint64_t mask(<classname> v)'))
+    table.insert(lines, apply('<indent>{'))
+    table.insert(lines, apply('<indent><indent>int b = bit(v);'))
+    table.insert(lines, apply('<indent><indent>return b < 0 || b >= <capacity> ? 0 : std::uint64_t(1) << b;'))
+    table.insert(lines, apply('<indent>}'))
+    table.insert(lines, apply('<indent>static constexpr int countr_zero(std::uint64_t m)'))
+    table.insert(lines, apply('<indent>{'))
+    table.insert(lines, apply('#if defined(__cpp_lib_bitops)'))
+    table.insert(lines, apply('<indent><indent>return std::countr_zero(m);'))
+    table.insert(lines, apply('#else'))
+    table.insert(lines, apply('<indent><indent>return __builtin_ctzll(m);'))
+    table.insert(lines, apply('#endif'))
+    table.insert(lines, apply('<indent>}'))
+    table.insert(lines, apply('<indent>static constexpr std::size_t popcount(std::uint64_t m)'))
+    table.insert(lines, apply('<indent>{'))
+    table.insert(lines, apply('#if defined(__cpp_lib_bitops)'))
+    table.insert(lines, apply('<indent><indent>return std::popcount(m);'))
+    table.insert(lines, apply('#else'))
+    table.insert(lines, apply('<indent><indent>return __builtin_popcountll(m);'))
+    table.insert(lines, apply('#endif'))
+    table.insert(lines, apply('<indent>}'))
+    table.insert(lines, apply(''))
+    table.insert(lines, apply('<indent>std::uint64_t bits_ = 0;'))
+    table.insert(lines, apply('};'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+---------------------------------------------------------------------------------------------------
+--- Public interface.
+---------------------------------------------------------------------------------------------------
+local M = {}
+
+---------------------------------------------------------------------------------------------------
+--- Generator will call this method to get kind of nodes that are of interest to each generator.
+---------------------------------------------------------------------------------------------------
+function M.digs()
+    log.trace("digs:")
+    return { "Enum" }
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate completion items. Class template specialization can not be declared in class scope.
+---------------------------------------------------------------------------------------------------
+function M.generate(node, alias, scope, acceptor)
+    log.trace("generate:", ast.details(node))
+
+    if G.enum.set.enabled and ast.is_enum(node) and scope ~= ast.Class then
+        if ast.count_children(node, function(n) return n.kind == "EnumConstant" end) > CAPACITY then
+            log.info("Too many enumerators for", G.enum.set.name, ast.details(node))
+            return
+        end
+        acceptor({ name = G.enum.set.name, trigger = G.enum.set.trigger, lines = set_decl_snippet() })
+        acceptor({ name = G.enum.set.name, trigger = G.enum.set.trigger, lines = set_spec_snippet(node, alias) })
+    end
+end
+
+---------------------------------------------------------------------------------------------------
+--- Info callback
+---------------------------------------------------------------------------------------------------
+function M.info()
+    log.trace("info")
+    local info = {}
+
+    if G.enum.set.enabled then
+        local name, trigger = G.enum.set.name, G.enum.set.trigger
+        table.insert(info, { name == trigger and name or name .. ' or ' .. trigger, "Enum bit set container" })
+    end
+
+    return info
+end
+
+---------------------------------------------------------------------------------------------------
+--- Initialization callback. Capture relevant parts of the configuration.
+---------------------------------------------------------------------------------------------------
+function M.setup(opts)
+    log.trace("setup")
+    G.keepindent = opts.keepindent
+    G.attribute  = opts.attribute
+    G.enum       = opts.enum
+    log.trace("setup:", G)
+end
+
+return M
@@ -0,0 +1,278 @@
+local ast = require('cppgen.ast')
+local log = require('cppgen.log')
+local utl = require('cppgen.generators.util')
+
+---------------------------------------------------------------------------------------------------
+-- FIX tag=value encoder generator. Fields are written as tag=value<SOH> directly into a caller
+-- supplied buffer, and the checksum is accumulated as the bytes are written. Tags come from the
+-- user supplied mapping function. The byte sums of the tag prefixes and SOH are computed here, so
+-- only the value bytes are summed at run time.
+---------------------------------------------------------------------------------------------------
+
+---------------------------------------------------------------------------------------------------
+-- Global parameters for code generation. Initialized in setup.
+---------------------------------------------------------------------------------------------------
+local G = {}
+
+---------------------------------------------------------------------------------------------------
+-- Private parameters for code generation.
+---------------------------------------------------------------------------------------------------
+local P = {}
+
+-- Apply parameters to the format string
+local function apply(format)
+    format = string.gsub(format, "<tag>", P.tag or '')
+    format = string.gsub(format, "<tagsum>", P.tagsum or '')
+
+    return utl.apply(P, format)
+end
+
+-- Byte sum of the tag prefix and the field terminating SOH
+local function tag_sum(prefix)
+    local sum = 1
+    for i = 1, string.len(prefix) do
+        sum = sum + string.byte(prefix, i)
+    end
+    return sum
+end
+
+-- Kind of the field type
+local function type_kind(node)
+    local kind = nil
+    ast.visit_children(node,
+        function(n)
+            if n.role == "type" then
+                kind = n.kind
+            end
+            return kind == nil
+        end
+    )
+    return kind
+end
+
+-- Collect fields and their tag prefixes for a class type node. Fields without a tag are skipped,
+-- unless they are of class type and marked as nested, in which case their fields are written in
+-- place.
+local function fields_and_tags(node, classname)
+    local records = {}
+    ast.visit_children(node,
+        function(n)
+            if not ast.anonymous(n) and (n.kind == "Field" or n.kind == "IndirectField") then
+                local record = {}
+                record.field = ast.name(n)
+                local tag    = G.class.fix.tag(classname, record.field, utl.camelize(record.field))
+                if tag ~= nil then
+                    record.prefix = tostring(tag) .. '='
+                    table.insert(records, record)
+                elseif type_kind(n) == "Record" and G.class.fix.nested(ast.type(n)) then
+                    table.insert(records, record)
+                end
+            end
+            return true
+        end
+    )
+    return records
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate encoder for a class type node.
+---------------------------------------------------------------------------------------------------
+local function class_snippet(node, alias, specifier)
+    log.debug("class_snippet:", ast.details(node))
+
+    P.specifier    = specifier
+    P.attribute    = G.attribute and ' ' .. G.attribute or ''
+    P.classname    = alias and ast.name(alias) or ast.name(node)
+    P.functionname = G.class.fix.name
+    P.indent       = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local records = fields_and_tags(node, P.classname)
+
+    local maxplen, maxflen = 0, 0
+    for _, r in ipairs(records) do
+        if r.prefix then
+            maxplen = math.max(maxplen, string.len(r.prefix))
+            maxflen = math.max(maxflen, string.len(r.field))
+        end
+    end
+
+    local lines = {}
+
+    table.insert(lines, apply('<specifier> <attribute> char* <functionname>(char* out, const <classname>& o, unsigned& checksum)'))
+    table.insert(lines, apply('{'))
+    if G.keepindent and #records > 0 then
+        table.insert(lines, apply('<indent>// clang-format off'))
+    end
+    for _, r in ipairs(records) do
+        P.fieldname = r.field
+        if r.prefix then
+            P.tag      = r.prefix
+            P.tagsum   = tostring(tag_sum(r.prefix))
+            P.labelpad = string.rep(' ', maxplen - string.len(r.prefix))
+            P.valuepad = string.rep(' ', maxflen - string.len(r.field))
+            table.insert(lines, apply('<indent>out = fix_field(out, "<tag>",<labelpad> <tagsum>, o.<fieldname>,<valuepad> checksum);'))
+        else
+            table.insert(lines, apply('<indent>out = <functionname>(out, o.<fieldname>, checksum);'))
+        end
+    end
+    if G.keepindent and #records > 0 then
+        table.insert(lines, apply('<indent>// clang-format on'))
+    end
+    table.insert(lines, apply('<indent>return out;'))
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+-- Collect distinct enumerators and the text of their values. Implicit values follow the preceding
+-- value. Values of other initializer expressions are not known here and are written at run time.
+local function labels_and_values(node, classname)
+    local records  = {}
+    local values   = {}
+    local declared = {}
+    local seen     = {}
+    local value    = -1
+    local char     = false
+    for _, r in ipairs(utl.enum_records(node)) do
+        local text = nil
+        if r.exact and r.kind == "CharacterLiteral" then
+            text  = utl.literal_text(r.value)
+            value = text and string.byte(text)
+            char  = true
+        elseif r.exact then
+            value = tonumber(r.value)
+            char  = false
+        elseif r.implicit then
+            value = value and value + 1
+        else
+            value = r.reference and values[r.reference]
+        end
+        if text == nil and value ~= nil then
+            text = char and value >= 32 and value < 127 and string.char(value) or string.format('%d', value)
+        end
+        -- Aliases would repeat a case label value
+        local aliased = r.reference ~= nil and declared[r.reference] or value ~= nil and seen[value]
+        values[r.label]   = value
+        declared[r.label] = true
+        if not aliased then
+            if value ~= nil then
+                seen[value] = true
+            end
+            table.insert(records, { label = classname .. '::' .. r.label, value = text and '"' .. text .. '"' })
+        end
+    end
+    return records
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate value writer for an enum type node. The enumerator value is the FIX field value.
+---------------------------------------------------------------------------------------------------
+local function enum_snippet(node, alias, specifier)
+    log.debug("enum_snippet:", ast.details(node))
+
+    P.specifier    = specifier
+    P.attribute    = G.attribute and ' ' .. G.attribute or ''
+    P.classname    = alias and ast.name(alias) or ast.name(node)
+    P.functionname = G.enum.fix.name
+    P.indent       = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local records = labels_and_values(node, P.classname)
+
+    local maxllen = 0
+    for _, r in ipairs(records) do
+        maxllen = math.max(maxllen, string.len(r.label))
+    end
+
+    local lines = {}
+
+    table.insert(lines, apply('<specifier> <attribute> char* <functionname>(char* out, <classname> o)'))
+    table.insert(lines, apply('{'))
+    table.insert(lines, apply('<indent>switch (o) {'))
+    if G.keepindent then
+        table.insert(lines, apply('<indent><indent>// clang-format off'))
+    end
+    for _, r in ipairs(records) do
+        P.label    = r.label
+        P.value    = r.value or ''
+        P.labelpad = string.rep(' ', maxllen - string.len(r.label))
+        if r.value then
+            table.insert(lines, apply('<indent><indent>case <label>:<labelpad> return fix_literal(out, <value>);'))
+        else
+            table.insert(lines, apply('<indent><indent>case <label>:<labelpad> return fix_value(out, static_cast<std::underlying_type_t<<classname>>>(o));'))
+        end
+    end
+    if G.keepindent then
+        table.insert(lines, apply('<indent><indent>// clang-format on'))
+    end
+    table.insert(lines, apply('<indent>}'))
+    table.insert(lines, apply('<indent>return out;'))
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+---------------------------------------------------------------------------------------------------
+--- Public interface.
+---------------------------------------------------------------------------------------------------
+local M = {}
+
+---------------------------------------------------------------------------------------------------
+--- Generator will call this method to get kind of nodes that are of interest to each generator.
+---------------------------------------------------------------------------------------------------
+function M.digs()
+    log.trace("digs:")
+    return { "Record", "CXXRecord", "ClassTemplate", "Enum" }
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate completion items
+---------------------------------------------------------------------------------------------------
+function M.generate(node, alias, scope, acceptor)
+    log.trace("generate:", ast.details(node))
+
+    local specifier = scope == ast.Class and 'friend' or 'inline'
+
+    if G.class.fix.enabled and ast.is_class(node) then
+        acceptor({ name = G.class.fix.name, trigger = G.class.fix.trigger, lines = class_snippet(node, alias, specifier) })
+    end
+    if G.enum.fix.enabled and ast.is_enum(node) then
+        acceptor({ name = G.enum.fix.name, trigger = G.enum.fix.trigger, lines = enum_snippet(node, alias, specifier) })
+    end
+end
+
+---------------------------------------------------------------------------------------------------
+--- Info callback
+---------------------------------------------------------------------------------------------------
+function M.info()
+    log.trace("info")
+    local info = {}
+
+    local function combine(name, trigger)
+        return name == trigger and name or name .. ' or ' .. trigger
+    end
+
+    if G.class.fix.enabled then
+        table.insert(info, { combine(G.class.fix.name, G.class.fix.trigger), "Class FIX tag=value encoder" })
+    end
+    if G.enum.fix.enabled then
+        table.insert(info, { combine(G.enum.fix.name, G.enum.fix.trigger), "Enum class FIX value writer" })
+    end
+
+    return info
+end
+
+---------------------------------------------------------------------------------------------------
+--- Initialization callback. Capture relevant parts of the configuration.
+---------------------------------------------------------------------------------------------------
+function M.setup(opts)
+    log.trace("setup")
+    G.keepindent = opts.keepindent
+    G.attribute  = opts.attribute
+    G.class      = opts.class
+    G.enum       = opts.enum
+    log.trace("setup:", G)
+end
+
+return M
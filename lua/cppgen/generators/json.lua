@@ -33,10 +33,38 @@ local function apply(format)
     format = string.gsub(format, "<nullcheck>", P.nullcheck or '')
     format = string.gsub(format, "<nullvalue>", P.nullvalue or '')
     format = string.gsub(format, "<default>", P.default or '')
+    format = string.gsub(format, "<key>", P.key or '')
+    format = string.gsub(format, "<string>", P.string or '')
+    format = string.gsub(format, "<empty>", P.empty or '')
+    format = string.gsub(format, "<resource>", P.resource or '')
+    format = string.gsub(format, "<mr>", P.mr or '')
 
     return utl.apply(P, format)
 end
 
+-- String type parameters. The allocator aware variant returns strings allocated from the memory
+-- resource passed as the last parameter, and passes it on to the serializers of the values.
+local function string_params(pmr)
+    P.string   = pmr and 'std::pmr::string' or 'std::string'
+    P.empty    = pmr and 'std::pmr::string(mr)' or 'std::string()'
+    P.resource = pmr and ', std::pmr::memory_resource* mr' or ''
+    P.mr       = pmr and ', mr' or ''
+end
+
+-- Verbosity parameter declaration. Compile time variant takes a std::true_type or std::false_type
+-- tag, which converts to bool when passed on to serializers that only take the runtime flag.
+local function verbose_param(compiletime)
+    return compiletime and 'std::bool_constant<Verbose> verbose' or 'bool verbose'
+end
+
+-- Generate runtime flag wrapper that selects one of the compile time variants.
+local function runtime_wrapper(lines, specifier, parameter)
+    table.insert(lines, apply(specifier .. ' <attribute> <string> <functionname>(' .. parameter .. ', bool verbose<resource>)'))
+    table.insert(lines, apply('{'))
+    table.insert(lines, apply('<indent>return verbose ? <functionname>(o, std::true_type()<mr>) : <functionname>(o, std::false_type()<mr>);'))
+    table.insert(lines, apply('}'))
+end
+
 -- Collect names and values for a class type node.
 local function class_labels_and_values(node, object)
     local records = {}
@@ -48,7 +76,7 @@ local function class_labels_and_values(node, object)
                 record.label = G.class.json.label(ast.name(node), record.field, utl.camelize(record.field))
 
                 -- Null handling checks
-                if G.class.json.nullcheck then
+                if G.class.json.nullcheck and utl.nullable(ast.type(n), G.nullability) then
                     if (object) then
                         record.nullcheck = G.class.json.nullcheck(object .. '.' .. record.field, ast.type(n))
                     else
@@ -64,12 +92,13 @@ local function class_labels_and_values(node, object)
                 end
                 -- Custom code will trigger field skipping when it sets either label or value to nil
                 if record.label ~= nil then
-                    if (object) then
-                        record.value = G.class.json.value(object .. '.' .. record.field, ast.type(n))
-                    else
-                        record.value = G.class.json.value(record.field, ast.type(n))
-                    end
+                    local fieldref = object and object .. '.' .. record.field or record.field
+                    record.value = G.class.json.value(fieldref, ast.type(n))
                     if record.value ~= nil then
+                        -- Custom value expressions are no longer arrays, so the extent goes with the field only
+                        if record.value == fieldref then
+                            record.extent = utl.array_extent(ast.type(n))
+                        end
                         table.insert(records, record)
                     end
                 end
@@ -83,68 +112,121 @@ end
 ---------------------------------------------------------------------------------------------------
 -- Generate serialization snippet for a class type node.
 ---------------------------------------------------------------------------------------------------
-local function save_class_snippet(node, alias, friend)
+local function save_class_snippet(node, alias, friend, pmr)
     log.debug("save_class_snippet:", ast.details(node))
 
+    string_params(pmr)
     P.attribute            = G.attribute or ''
     P.classname            = alias and ast.name(alias) or ast.name(node)
     P.functionname         = G.class.json.name
     P.indent               = string.rep(' ', vim.lsp.util.get_effective_tabstop())
 
     local records          = class_labels_and_values(node, 'o')
+
+    -- C array fields are passed along with their element count to the sequence serializer
+    for _, r in ipairs(records) do
+        if r.extent then
+            r.value = r.value .. ', ' .. r.extent
+        end
+    end
     local maxllen, maxvlen = max_lengths(records)
 
+    -- Stable partition, fields without null check go first
+    if G.class.json.groupnonnull then
+        local nonnull, nullable = {}, {}
+        for _, r in ipairs(records) do
+            table.insert(r.nullcheck and nullable or nonnull, r)
+        end
+        records = utl.combine(nonnull, nullable)
+    end
+
     local lines            = {}
 
+    local compiletime      = G.class.json.compiletime
+    local template         = compiletime and 'template<bool Verbose> ' or ''
+
     if friend then
-        table.insert(lines, apply('friend <attribute> std::string <functionname>(const <classname>& o, bool verbose)'))
+        table.insert(lines, apply(template .. 'friend <attribute> <string> <functionname>(const <classname>& o, ' .. verbose_param(compiletime) .. '<resource>)'))
     else
-        table.insert(lines, apply('inline <attribute> std::string <functionname>(const <classname>& o, bool verbose)'))
+        table.insert(lines, apply(template .. 'inline <attribute> <string> <functionname>(const <classname>& o, ' .. verbose_param(compiletime) .. '<resource>)'))
     end
     table.insert(lines, apply('{'))
-    table.insert(lines, apply('<indent>return std::string()'))
+    table.insert(lines, apply('<indent>return <empty>'))
     if G.keepindent then
         table.insert(lines, apply('<indent>// clang-format off'))
     end
-    table.insert(lines, apply('<indent>+ "{"'))
+
+    -- Keys known at generation time are emitted as literals, together with the colon and the leading brace or comma.
+    -- Fields skipped when null may leave the object without members, the brace is emitted on its own then.
+    local literal = G.class.json.literalkeys
+    local skipped = 0
+    if literal then
+        skipped = utl.json_literal_keys(records)
+        maxllen = 0
+        for _, r in ipairs(records) do
+            maxllen = math.max(maxllen, string.len(r.key))
+        end
+    end
+
+    if not literal or #records == 0 or skipped > 0 then
+        table.insert(lines, apply('<indent>+ "{"'))
+    end
 
     --- No null check variation
     local function straight_line()
+        if literal then
+            return
+            '<key><labelpad> + <functionname>(<value><valuepad>, verbose<mr>)'
+        end
         return
-        '<functionname>("<label>")<labelpad> + <colon> + <functionname>(<value><valuepad>, verbose)'
+        '<functionname>("<label>"<mr>)<labelpad> + <colon> + <functionname>(<value><valuepad>, verbose<mr>)'
     end
     --- Print null variation
     local function shownull_line()
+        if literal then
+            return
+            '<key><labelpad> + (<nullcheck><valuepad> ? <functionname>(<nullvalue>, verbose<mr>) : <functionname>(<value><valuepad>, verbose<mr>))'
+        end
         return
-        '<functionname>("<label>")<labelpad> + <colon> + (<nullcheck><valuepad> ? <functionname>(<nullvalue>, verbose) : <functionname>(<value><valuepad>, verbose))'
+        '<functionname>("<label>"<mr>)<labelpad> + <colon> + (<nullcheck><valuepad> ? <functionname>(<nullvalue>, verbose<mr>) : <functionname>(<value><valuepad>, verbose<mr>))'
     end
     --- Skip null variation
     local function skipnull_line()
+        if literal then
+            return
+            '(<nullcheck><valuepad> ? "" : <key><labelpad> + <functionname>(<value><valuepad>, verbose<mr>))'
+        end
         return
-        '(<nullcheck><valuepad> ? "" : <functionname>("<label>")<labelpad> + <colon> + <functionname>(<value><valuepad>, verbose))'
+        '(<nullcheck><valuepad> ? "" : <functionname>("<label>"<mr>)<labelpad> + <colon> + <functionname>(<value><valuepad>, verbose<mr>))'
+    end
+
+    --- Field separator, unless it is already a part of the key literal
+    local function separator(last)
+        return (last or literal) and '' or ' + <comma>'
     end
 
     --- Get no-null-check code variation
     local function straight_code(l, last)
-        table.insert(l, apply('<indent>+ ' .. straight_line() .. (last and '' or ' + <comma>')))
+        table.insert(l, apply('<indent>+ ' .. straight_line() .. separator(last)))
     end
 
     --- Get skip-null code variation
     local function skipnull_code(l, last)
-        table.insert(l, apply('<indent>+ ' .. skipnull_line() .. (last and '' or ' + <comma>')))
+        table.insert(l, apply('<indent>+ ' .. skipnull_line() .. separator(last)))
     end
 
     --- Get show-null code variation
     local function shownull_code(l, last)
-        table.insert(l, apply('<indent>+ ' .. shownull_line() .. (last and '' or ' + <comma>')))
+        table.insert(l, apply('<indent>+ ' .. shownull_line() .. separator(last)))
     end
 
     local idx = 1
     for _, r in ipairs(records) do
         P.fieldname = r.field
         P.label     = r.label
+        P.key       = r.key
         P.value     = r.value
-        P.labelpad  = string.rep(' ', maxllen - string.len(r.label))
+        P.labelpad  = string.rep(' ', maxllen - string.len(r.key or r.label))
         P.valuepad  = string.rep(' ', maxvlen - string.len(r.value))
         P.nullcheck = r.nullcheck
         P.nullvalue = r.nullvalue
@@ -167,6 +249,10 @@ local function save_class_snippet(node, alias, friend)
     end
     table.insert(lines, apply('}'))
 
+    if compiletime then
+        runtime_wrapper(lines, friend and 'friend' or 'inline', 'const <classname>& o')
+    end
+
     for _, l in ipairs(lines) do log.debug(l) end
     return lines
 end
@@ -179,15 +265,24 @@ local function save_class_items(lines)
     }
 end
 
+-- Generate serialization function followed by the allocator aware overload, if enabled.
+local function save_class_snippets(node, alias, friend)
+    local lines = save_class_snippet(node, alias, friend, false)
+    if G.pmr.enabled then
+        utl.append(lines, save_class_snippet(node, alias, friend, true))
+    end
+    return lines
+end
+
 -- Generate serialization function snippet items for a class type node.
 local function save_class_friend_items(node, alias)
     log.trace("save_class_friend_items:", ast.details(node))
-    return save_class_items(save_class_snippet(node, alias, true))
+    return save_class_items(save_class_snippets(node, alias, true))
 end
 
 local function save_class_free_items(node, alias)
     log.trace("save_class_free_items:", ast.details(node))
-    return save_class_items(save_class_snippet(node, alias, false))
+    return save_class_items(save_class_snippets(node, alias, false))
 end
 
 -- Collect names and values for an enum type node. Labels are fixed, values are calculated.
@@ -201,23 +296,28 @@ local function enum_labels_and_values(node, alias, vf)
         record.value = vf(r.label, r.value) or r.label
         table.insert(lsandvs, record)
     end
-    return lsandvs
+    return utl.by_frequency(lsandvs, G.profile)
 end
 
 ---------------------------------------------------------------------------------------------------
 -- Generate serialization snippet for an enum type node.
 ---------------------------------------------------------------------------------------------------
-local function save_enum_snippet(node, alias)
+local function save_enum_snippet(node, alias, pmr)
     log.trace("save_enum_snippet:", ast.details(node))
 
+    string_params(pmr)
     P.attribute    = G.attribute or ''
     P.classname    = alias and ast.name(alias) or ast.name(node)
     P.functionname = G.enum.json.name
     P.indent       = string.rep(' ', vim.lsp.util.get_effective_tabstop())
 
-    local lines    = {}
+    local lines       = {}
+    local compiletime = G.enum.json.compiletime
 
-    table.insert(lines, apply('inline <attribute> std::string <functionname>(<classname> o, bool verbose)'))
+    if compiletime then
+        table.insert(lines, apply('template<bool Verbose>'))
+    end
+    table.insert(lines, apply('inline <attribute> <string> <functionname>(<classname> o, ' .. verbose_param(compiletime) .. '<resource>)'))
     table.insert(lines, apply('{'))
 
     -- Helper function to generate switch statement
@@ -237,15 +337,16 @@ local function save_enum_snippet(node, alias)
             P.value    = r.value
             P.labelpad = string.rep(' ', maxllen - string.len(r.label))
             P.valuepad = string.rep(' ', maxvlen - string.len(r.value))
+            P.likely   = utl.likely(r, G.profile)
             table.insert(lines,
                 apply(indent ..
-                '<indent><indent>case <label>:<labelpad> return <functionname>(<value><valuepad>, verbose); break;'))
+                '<indent><indent>case <label>:<labelpad> <likely>return <functionname>(<value><valuepad>, verbose<mr>); break;'))
         end
 
         if default then
             P.default = default
             table.insert(lines,
-                apply(indent .. '<indent><indent>default: return <functionname>(<default>, verbose); break;'))
+                apply(indent .. '<indent><indent>default: return <functionname>(<default>, verbose<mr>); break;'))
         end
 
         if G.keepindent then
@@ -277,17 +378,21 @@ local function save_enum_snippet(node, alias)
     if (same(vrecords, trecords)) then
         switch(lines, vrecords, vdefault)
     else
-        table.insert(lines, apply('<indent>if (verbose) {'))
+        table.insert(lines, apply(compiletime and '<indent>if constexpr (Verbose) {' or '<indent>if (verbose) {'))
         switch(lines, vrecords, vdefault, true)
         table.insert(lines, apply('<indent>} else {'))
         switch(lines, trecords, tdefault, true)
         table.insert(lines, apply('<indent>}'))
     end
 
-    table.insert(lines, apply('<indent>return <functionname>("", verbose);'))
+    table.insert(lines, apply('<indent>return <functionname>("", verbose<mr>);'))
 
     table.insert(lines, apply('}'))
 
+    if compiletime then
+        runtime_wrapper(lines, 'inline', '<classname> o')
+    end
+
     for _, l in ipairs(lines) do log.debug(l) end
     return lines
 end
@@ -300,10 +405,133 @@ local function save_enum_items(lines)
     }
 end
 
--- Generate serialization function snippet items for a class type node.
+-- Generate serialization function snippet items for an enum type node, followed by the allocator
+-- aware overload, if enabled.
 local function save_enum_free_items(node, alias)
     log.trace("save_enum_free_items:", ast.details(node))
-    return save_enum_items(save_enum_snippet(node, alias, false))
+    local lines = save_enum_snippet(node, alias, false)
+    if G.pmr.enabled then
+        utl.append(lines, save_enum_snippet(node, alias, true))
+    end
+    return save_enum_items(lines)
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate maximum JSON size function for a class type node. Field types are taken from the
+-- serialized value expressions, so the sizes of nested types are computed recursively.
+---------------------------------------------------------------------------------------------------
+local function max_size_class_snippet(node, alias, specifier)
+    log.debug("max_size_class_snippet:", ast.details(node))
+
+    P.specifier    = specifier
+    P.attribute    = G.attribute or ''
+    P.classname    = alias and ast.name(alias) or ast.name(node)
+    P.indent       = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local records  = class_labels_and_values(node, 'std::declval<const ' .. P.classname .. '&>()')
+    local maxklen  = 0
+    for _, r in ipairs(records) do
+        -- Opening brace or comma, then the quoted key and colon
+        r.keysize = tostring(1 + utl.json_key_size(r.label))
+        maxklen   = math.max(maxklen, string.len(r.keysize))
+    end
+
+    local lines    = {}
+
+    table.insert(lines, apply('<specifier> <attribute> std::size_t max_json_size(const <classname>*)'))
+    table.insert(lines, apply('{'))
+    table.insert(lines, apply('<indent>return std::size_t(0)'))
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format off'))
+    end
+    for _, r in ipairs(records) do
+        P.value    = r.value
+        P.labelpad = string.rep(' ', maxklen - string.len(r.keysize))
+        if r.nullcheck and r.nullvalue then
+            P.nullvalue = r.nullvalue
+            table.insert(lines, apply('<indent>+ ' .. r.keysize .. '<labelpad> + std::max(max_json_size<decltype(<nullvalue>)>(), max_json_size<decltype(<value>)>())'))
+        else
+            table.insert(lines, apply('<indent>+ ' .. r.keysize .. '<labelpad> + max_json_size<decltype(<value>)>()'))
+        end
+    end
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format on'))
+    end
+    table.insert(lines, apply(#records == 0 and '<indent>+ 2;' or '<indent>+ 1;'))
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate maximum JSON size function for an enum type node. Sizes of literal values are computed
+-- here. The default case is assumed to print the underlying value, possibly with literal text.
+---------------------------------------------------------------------------------------------------
+local function max_size_enum_snippet(node, alias)
+    log.debug("max_size_enum_snippet:", ast.details(node))
+
+    P.attribute   = G.attribute or ''
+    P.classname   = alias and ast.name(alias) or ast.name(node)
+    P.indent      = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local literal = 0
+    local terms   = {}
+
+    -- JSON size of a value expression, quoted if it is a character or string literal
+    local function add(value)
+        local size = utl.literal_size(value)
+        if size then
+            literal = math.max(literal, size + (string.match(value, '^[\'"]') and 2 or 0))
+        else
+            table.insert(terms, 'max_json_size<decltype(' .. value .. ')>()')
+        end
+    end
+    -- JSON size of a default expression
+    local function add_default(default)
+        local size, count = utl.embedded_literals_size(default)
+        if count > 0 then
+            -- Text concatenated to the promoted underlying value
+            table.insert(terms, tostring(size + 2) .. ' + max_json_size<decltype(+std::declval<std::underlying_type_t<' .. P.classname .. '>>())>()')
+        else
+            table.insert(terms, 'max_json_size<std::underlying_type_t<' .. P.classname .. '>>()')
+        end
+    end
+
+    for _, r in ipairs(enum_labels_and_values(node, alias, G.enum.json.verbose.value)) do
+        add(r.value)
+    end
+    for _, r in ipairs(enum_labels_and_values(node, alias, G.enum.json.terse.value)) do
+        add(r.value)
+    end
+    if G.enum.json.verbose.default then
+        add_default(G.enum.json.verbose.default(P.classname, 'o'))
+    end
+    if G.enum.json.terse.default then
+        add_default(G.enum.json.terse.default(P.classname, 'o'))
+    end
+
+    local lines   = {}
+
+    table.insert(lines, apply('constexpr <attribute> std::size_t max_json_size(const <classname>*)'))
+    table.insert(lines, apply('{'))
+    if #terms == 0 then
+        table.insert(lines, apply('<indent>return ' .. literal .. ';'))
+    else
+        table.insert(lines, apply('<indent>return std::max<std::size_t>({ ' .. literal .. ', ' .. table.concat(terms, ', ') .. ' });'))
+    end
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+-- Generate maximum size completion items
+local function max_size_items(lines, trigger)
+    return
+    {
+        { name = 'max_json_size', trigger = trigger, lines = lines }
+    }
 end
 
 ---------------------------------------------------------------------------------------------------
@@ -336,12 +564,25 @@ function M.generate(node, alias, scope, acceptor)
                     acceptor(item)
                 end
             end
+            if G.class.json.maxsize then
+                local specifier = scope == ast.Class and 'friend constexpr' or 'constexpr'
+                for _, item in ipairs(max_size_items(max_size_class_snippet(node, alias, specifier), G.class.json.trigger)) do
+                    acceptor(item)
+                end
+            end
         end
     end
 
-    if ast.is_enum(node) then
-        for _, item in ipairs(save_enum_free_items(node, alias)) do
-            acceptor(item)
+    if G.enum.json.enabled then
+        if ast.is_enum(node) then
+            for _, item in ipairs(save_enum_free_items(node, alias)) do
+                acceptor(item)
+            end
+            if G.enum.json.maxsize then
+                for _, item in ipairs(max_size_items(max_size_enum_snippet(node, alias), G.enum.json.trigger)) do
+                    acceptor(item)
+                end
+            end
         end
     end
 end
@@ -372,10 +613,13 @@ end
 ---------------------------------------------------------------------------------------------------
 function M.setup(opts)
     log.trace("setup")
-    G.keepindent = opts.keepindent
-    G.attribute  = opts.attribute
-    G.class      = opts.class
-    G.enum       = opts.enum
+    G.keepindent  = opts.keepindent
+    G.attribute   = opts.attribute
+    G.class       = opts.class
+    G.nullability = opts.nullability
+    G.enum        = opts.enum
+    G.profile     = opts.profile
+    G.pmr         = opts.pmr
     log.trace("setup:", G)
 end
 
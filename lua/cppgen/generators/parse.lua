@@ -0,0 +1,234 @@
+local ast = require('cppgen.ast')
+local log = require('cppgen.log')
+local utl = require('cppgen.generators.util')
+
+---------------------------------------------------------------------------------------------------
+-- Text parser generators. Parsers read back the text written by the output stream shift operators,
+-- using the same preamble, label, separator and enumerator value options.
+---------------------------------------------------------------------------------------------------
+
+---------------------------------------------------------------------------------------------------
+-- Global parameters for code generation. Initialized in setup.
+---------------------------------------------------------------------------------------------------
+local G = {}
+
+---------------------------------------------------------------------------------------------------
+-- Private parameters for code generation.
+---------------------------------------------------------------------------------------------------
+local P = {}
+
+-- Apply parameters to the format string
+local function apply(format)
+    format = string.gsub(format, "<delimiter>", P.delimiter or '')
+
+    return utl.apply(P, format)
+end
+
+-- Collect field names and the labels printed in front of them for a class type node.
+local function fields_and_labels(node)
+    local records = {}
+    ast.visit_children(node,
+        function(n)
+            if not ast.anonymous(n) and (n.kind == "Field" or n.kind == "IndirectField") then
+                local record = {}
+                record.field = ast.name(n)
+                record.label = G.class.shift.label(ast.name(node), record.field, utl.camelize(record.field))
+                table.insert(records, record)
+            end
+            return true
+        end
+    )
+    return records
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate parser for a class type node. The text of each field extends up to the separator and
+-- label of the next field, so a single forward pass splits the line and hands each piece to the
+-- parser of the field type. Nested classes are parsed in place, consuming their own fields before
+-- the delimiter is searched for, so their text may contain it. The in place parser consumes the
+-- text up to the given end delimiter, the other one the whole text.
+---------------------------------------------------------------------------------------------------
+local function class_snippet(node, alias, specifier)
+    log.debug("class_snippet:", ast.details(node))
+
+    -- Separator is an expression, we can only search for it if it is a literal
+    local separator = utl.literal_text(G.class.shift.separator)
+    if separator == nil then
+        log.info("Can not parse text with non-literal separator", G.class.shift.separator)
+        return nil
+    end
+
+    P.specifier    = specifier
+    P.attribute    = G.attribute and ' ' .. G.attribute or ''
+    P.classname    = alias and ast.name(alias) or ast.name(node)
+    P.functionname = G.class.parse.name
+    P.indent       = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local preamble = G.class.shift.preamble and G.class.shift.preamble(P.classname) or ''
+    local records  = fields_and_labels(node)
+
+    for i, r in ipairs(records) do
+        r.delimiter = i == 1 and preamble .. r.label or separator .. r.label
+    end
+    -- Last field extends up to the end delimiter
+    local maxdlen = string.len('end')
+    for i = 2, #records do
+        records[i].delimiter = '"' .. records[i].delimiter .. '"'
+        maxdlen = math.max(maxdlen, string.len(records[i].delimiter))
+    end
+
+    local lines = {}
+
+    table.insert(lines, apply('<specifier> <attribute> bool <functionname>(std::string_view& s, <classname>& o, std::string_view end)'))
+    table.insert(lines, apply('{'))
+    if #records == 0 then
+        P.delimiter = preamble
+        table.insert(lines, apply('<indent>return parse_literal(s, "<delimiter>") && parse_literal(s, end);'))
+    else
+        if G.keepindent then
+            table.insert(lines, apply('<indent>// clang-format off'))
+        end
+        P.delimiter = records[1].delimiter
+        table.insert(lines, apply('<indent>return parse_literal(s, "<delimiter>")'))
+        for i = 2, #records + 1 do
+            P.delimiter = i <= #records and records[i].delimiter or 'end'
+            P.fieldname = records[i - 1].field
+            P.labelpad  = string.rep(' ', maxdlen - string.len(P.delimiter))
+            table.insert(lines, apply('<indent>    && parse_field(s, <delimiter>,<labelpad> o.<fieldname>)' .. (i > #records and ';' or '')))
+        end
+        if G.keepindent then
+            table.insert(lines, apply('<indent>// clang-format on'))
+        end
+    end
+    table.insert(lines, apply('}'))
+    table.insert(lines, apply('<specifier> <attribute> bool <functionname>(std::string_view s, <classname>& o)'))
+    table.insert(lines, apply('{'))
+    table.insert(lines, apply('<indent>return <functionname>(s, o, std::string_view()) && s.empty();'))
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate parser for an enum type node. Compares the text against the strings printed by the
+-- shift operator, hottest enumerators first when a frequency profile is configured.
+---------------------------------------------------------------------------------------------------
+local function enum_snippet(node, alias, specifier)
+    log.debug("enum_snippet:", ast.details(node))
+
+    P.specifier    = specifier
+    P.attribute    = G.attribute and ' ' .. G.attribute or ''
+    P.classname    = alias and ast.name(alias) or ast.name(node)
+    P.functionname = G.enum.parse.name
+    P.indent       = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local records = {}
+    for _, r in ipairs(utl.enum_records(node)) do
+        local record = {}
+        record.label = P.classname .. '::' .. r.label
+        record.value = G.enum.shift.value(r.label or '', r.value or '')
+        if record.value then
+            table.insert(records, record)
+        end
+    end
+    records = utl.by_frequency(records, G.profile)
+
+    local maxllen, maxvlen = 0, 0
+    for _, r in ipairs(records) do
+        maxllen = math.max(maxllen, string.len(r.label))
+        maxvlen = math.max(maxvlen, string.len(r.value))
+    end
+
+    local lines = {}
+
+    table.insert(lines, apply('<specifier> <attribute> bool <functionname>(std::string_view v, <classname>& o)'))
+    table.insert(lines, apply('{'))
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format off'))
+    end
+    for _, r in ipairs(records) do
+        P.label    = r.label
+        P.value    = r.value
+        P.labelpad = string.rep(' ', maxllen - string.len(r.label))
+        P.valuepad = string.rep(' ', maxvlen - string.len(r.value))
+        P.likely   = utl.likely(r, G.profile)
+        table.insert(lines, apply('<indent>if (v == <value>)<valuepad> <likely>{ o = <label>;<labelpad> return true; }'))
+    end
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format on'))
+    end
+    table.insert(lines, apply('<indent>return false;'))
+    table.insert(lines, apply('}'))
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+---------------------------------------------------------------------------------------------------
+--- Public interface.
+---------------------------------------------------------------------------------------------------
+local M = {}
+
+---------------------------------------------------------------------------------------------------
+--- Generator will call this method to get kind of nodes that are of interest to each generator.
+---------------------------------------------------------------------------------------------------
+function M.digs()
+    log.trace("digs:")
+    return { "Record", "CXXRecord", "ClassTemplate", "Enum" }
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate completion items
+---------------------------------------------------------------------------------------------------
+function M.generate(node, alias, scope, acceptor)
+    log.trace("generate:", ast.details(node))
+
+    local specifier = scope == ast.Class and 'friend' or 'inline'
+
+    if G.class.parse.enabled and ast.is_class(node) then
+        local lines = class_snippet(node, alias, specifier)
+        if lines then
+            acceptor({ name = G.class.parse.name, trigger = G.class.parse.trigger, lines = lines })
+        end
+    end
+    if G.enum.parse.enabled and ast.is_enum(node) then
+        acceptor({ name = G.enum.parse.name, trigger = G.enum.parse.trigger, lines = enum_snippet(node, alias, specifier) })
+    end
+end
+
+---------------------------------------------------------------------------------------------------
+--- Info callback
+---------------------------------------------------------------------------------------------------
+function M.info()
+    log.trace("info")
+    local info = {}
+
+    local function combine(name, trigger)
+        return name == trigger and name or name .. ' or ' .. trigger
+    end
+
+    if G.class.parse.enabled then
+        table.insert(info, { combine(G.class.parse.name, G.class.parse.trigger), "Class parser of output stream shift operator text" })
+    end
+    if G.enum.parse.enabled then
+        table.insert(info, { combine(G.enum.parse.name, G.enum.parse.trigger), "Enum class parser of output stream shift operator text" })
+    end
+
+    return info
+end
+
+---------------------------------------------------------------------------------------------------
+--- Initialization callback. Capture relevant parts of the configuration.
+---------------------------------------------------------------------------------------------------
+function M.setup(opts)
+    log.trace("setup")
+    G.keepindent = opts.keepindent
+    G.attribute  = opts.attribute
+    G.class      = opts.class
+    G.enum       = opts.enum
+    G.profile    = opts.profile
+    log.trace("setup:", G)
+end
+
+return M
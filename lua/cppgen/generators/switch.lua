@@ -17,9 +17,9 @@ local G = {}
 ---------------------------------------------------------------------------------------------------
 local P = {}
 
--- Capture parameters
+-- LSP clients attached to buffers
 local L = {
-    lspclient = nil
+    clients = {}
 }
 
 -- Apply parameters to the format string
@@ -42,7 +42,7 @@ local function enum_labels_and_values(node)
             return true
         end
     )
-    return records
+    return utl.by_frequency(records, G.profile)
 end
 
 -- Calculate the longest length of labels and values
@@ -75,8 +75,9 @@ local function case_enum_snippet(defnode, refnode)
         P.value    = r.value
         P.labelpad = string.rep(' ', maxllen - string.len(P.label))
         P.valuepad = string.rep(' ', maxvlen - string.len(P.value))
+        P.likely   = utl.likely(r, G.profile)
 
-        table.insert(lines, apply('case <label>:'))
+        table.insert(lines, apply('<likely>case <label>:'))
         table.insert(lines, apply('<indent><value>;'))
         table.insert(lines, apply('<indent>break;'))
     end
@@ -125,11 +126,19 @@ end
 local M = {}
 
 ---------------------------------------------------------------------------------------------------
---- We need to capture a reference to the LSP client so we implement this callback
+--- We need to capture a reference to the LSP client of each buffer so we implement this callback
 ---------------------------------------------------------------------------------------------------
 function M.attached(client, bufnr)
     log.trace("Attached client", client.id, "buffer", bufnr)
-    L.lspclient = client
+    L.clients[bufnr] = client
+end
+
+---------------------------------------------------------------------------------------------------
+--- Forget the client of a wiped out buffer
+---------------------------------------------------------------------------------------------------
+function M.detached(bufnr)
+    log.trace("Detached buffer", bufnr)
+    L.clients[bufnr] = nil
 end
 
 ---------------------------------------------------------------------------------------------------
@@ -143,14 +152,15 @@ end
 ---------------------------------------------------------------------------------------------------
 -- Generate from string functions for an enum nodes.
 ---------------------------------------------------------------------------------------------------
-function M.generate(node, alias, scope, acceptor)
+function M.generate(node, alias, scope, acceptor, bufnr)
     log.trace("generate:", ast.details(node))
 
     if G.enum.switch.enabled then
-        local cond = get_switch_condition_node(node)
-        if cond then
+        local cond   = get_switch_condition_node(node)
+        local client = L.clients[bufnr or vim.api.nvim_get_current_buf()]
+        if cond and client then
             log.debug("generate:", "condition node", ast.details(cond))
-            lsp.get_type_definition(L.lspclient, cond, function(n)
+            lsp.get_type_definition(client, cond, function(n)
                 log.debug("generate:", "definition node", ast.details(n))
                 for _, item in ipairs(case_enum_item(n, cond)) do
                     acceptor(item)
@@ -179,7 +189,8 @@ end
 ---------------------------------------------------------------------------------------------------
 function M.setup(opts)
     log.trace("setup")
-    G.enum = opts.enum
+    G.enum    = opts.enum
+    G.profile = opts.profile
     log.trace("setup:", G)
 end
 
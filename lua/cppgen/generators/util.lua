@@ -24,12 +24,82 @@ local function enum_value_and_kind(node)
     return v, k
 end
 
--- Return name, value and type of enum constant.
+-- Nodes wrapping an enumerator initializer without changing its value
+local transparent = { ConstantExpr = true, ImplicitCast = true, Paren = true }
+
+-- Classify the initializer of enum constant. Returns the literal text and kind when the initializer
+-- is a plain, possibly negated, literal, the name of the enumerator when it refers to another one,
+-- and nothing for any other expression.
+local function enum_initializer(node)
+    local n = node.children and node.children[1]
+    while n and transparent[n.kind] and n.children and #n.children == 1 do
+        n = n.children[1]
+    end
+    if n == nil then
+        return nil
+    end
+    if n.kind == "IntegerLiteral" or n.kind == "CharacterLiteral" then
+        return { literal = n.detail, kind = n.kind }
+    end
+    if n.kind == "UnaryOperator" and n.detail == "-" and n.children and #n.children == 1 then
+        local c = n.children[1]
+        if c.kind == "IntegerLiteral" then
+            return { literal = '-' .. c.detail, kind = c.kind }
+        end
+    end
+    if n.kind == "DeclRef" then
+        return { reference = n.detail }
+    end
+    return {}
+end
+
+-- Return name, value and type of enum constant. Value is the first literal found in the initializer
+-- and is exact only when the initializer is a literal, see enum_initializer.
 local function enum_record(node)
     log.trace("enum_record:", ast.details(node))
 
     local v, k = enum_value_and_kind(node)
-    return { label = ast.name(node), value = v, kind = k }
+    local init = enum_initializer(node)
+    if init and init.literal then
+        v, k = init.literal, init.kind
+    end
+    return {
+        label     = ast.name(node),
+        value     = v,
+        kind      = k,
+        implicit  = init == nil,
+        exact     = init ~= nil and init.literal ~= nil,
+        reference = init and init.reference
+    }
+end
+
+-- Loaded frequency profiles, keyed by file name.
+local profiles = {}
+
+-- Load Enum::Value,count records from the profile file. Reload when the file changes.
+local function load_profile(file)
+    local stat = (vim.uv or vim.loop).fs_stat(file)
+    if not stat then
+        log.warn("Unable to access profile file", file)
+        return nil
+    end
+    local cached = profiles[file]
+    if cached and cached.mtime == stat.mtime.sec and cached.size == stat.size then
+        return cached.counts
+    end
+
+    local counts = {}
+    for line in io.lines(file) do
+        local key, count = string.match(line, '^%s*([^,]-)%s*,%s*(%d+)%s*$')
+        if key then
+            -- Ignore namespaces, keep enumeration name and the enumerator
+            key = string.match(key, '([^:]+::[^:]+)$') or key
+            counts[key] = (counts[key] or 0) + tonumber(count)
+        end
+    end
+    profiles[file] = { mtime = stat.mtime.sec, size = stat.size, counts = counts }
+    log.info("Loaded profile file", file)
+    return counts
 end
 
 local M = {}
@@ -52,6 +122,98 @@ function M.enum_records(node)
     return records
 end
 
+---------------------------------------------------------------------------------------------------
+-- Check if a field of a given type can hold a null value. User rule takes precedence over patterns.
+---------------------------------------------------------------------------------------------------
+function M.nullable(type, rules)
+    if type == nil or rules == nil then
+        return true
+    end
+    if rules.nullable then
+        local nullable = rules.nullable(type)
+        if nullable ~= nil then
+            return nullable
+        end
+    end
+    local name = string.gsub(string.gsub(type, '^const ', ''), '^volatile ', '')
+    for _, pattern in ipairs(rules.nonnull or {}) do
+        if string.find(name, pattern) then
+            return false
+        end
+    end
+    return true
+end
+
+---------------------------------------------------------------------------------------------------
+-- Return the element count of a one dimensional C array type, as written in the type. Returns nil
+-- for other types, for declarators such as pointers to arrays, and for character arrays, which
+-- hold text rather than a sequence.
+---------------------------------------------------------------------------------------------------
+function M.array_extent(type)
+    local element, extent = string.match(type or '', '^(.-)%s*%[([^%[%]]+)%]$')
+    if element == nil or string.find(element, '[%[%]%(]') then
+        return nil
+    end
+    element = string.gsub(string.gsub(element, '^const ', ''), '^volatile ', '')
+    if string.find(element, 'char$') or string.find(element, '^char%d+_t$') or element == 'wchar_t' then
+        return nil
+    end
+    return extent
+end
+
+---------------------------------------------------------------------------------------------------
+-- Order enum records hottest first, using the frequency profile. Records with equal counts keep
+-- their relative order. Records are annotated with likelihood used by the likely function. The key
+-- function returns the Enum::Value profile key of a record, defaults to the record label.
+---------------------------------------------------------------------------------------------------
+function M.by_frequency(records, profile, key)
+    if profile == nil or profile.file == nil then
+        return records
+    end
+    local counts = load_profile(profile.file)
+    if counts == nil then
+        return records
+    end
+    key = key or function(r) return r.label end
+
+    local total = 0
+    local order = {}
+    for i, r in ipairs(records) do
+        local k = string.match(key(r), '([^:]+::[^:]+)$') or key(r)
+        order[i] = { record = r, index = i, count = counts[k] or 0 }
+        total = total + order[i].count
+    end
+    table.sort(order, function(a, b)
+        if a.count ~= b.count then
+            return a.count > b.count
+        end
+        return a.index < b.index
+    end)
+
+    local sorted = {}
+    for i, o in ipairs(order) do
+        if total > 0 and o.count > total * profile.likely then
+            o.record.likelihood = 'likely'
+        elseif total > 0 and o.count < total * profile.unlikely then
+            o.record.likelihood = 'unlikely'
+        else
+            o.record.likelihood = nil
+        end
+        sorted[i] = o.record
+    end
+    return sorted
+end
+
+---------------------------------------------------------------------------------------------------
+-- Return likelihood attribute for a record ordered by frequency, followed by a space.
+---------------------------------------------------------------------------------------------------
+function M.likely(record, profile)
+    if profile and profile.attributes and record.likelihood then
+        return '[[' .. record.likelihood .. ']] '
+    end
+    return ''
+end
+
 ---------------------------------------------------------------------------------------------------
 -- Convert snake_case to CamelCase.
 ---------------------------------------------------------------------------------------------------
@@ -63,6 +225,115 @@ function M.camelize(s)
     return (string.gsub(s, '%W*(%w+)', capitalize))
 end
 
+-- Escape a string so it can be placed between double quotes in JSON text
+local function json_escape(s)
+    return (string.gsub(s, '[%c"\\]', function(c)
+        if c == '"' or c == '\\' then
+            return '\\' .. c
+        end
+        return string.format('\\u%04x', string.byte(c))
+    end))
+end
+
+-- Escape a string so it can be placed in C++ string literal
+local function cpp_escape(s)
+    return (string.gsub(s, '["\\]', '\\%0'))
+end
+
+---------------------------------------------------------------------------------------------------
+-- Return C++ string literal with quoted JSON key and colon, preceded by the opening brace or a comma.
+---------------------------------------------------------------------------------------------------
+function M.json_key(label, first)
+    return '"' .. cpp_escape((first and '{' or ',') .. '"' .. json_escape(label) .. '":') .. '"'
+end
+
+---------------------------------------------------------------------------------------------------
+-- Return C++ string literal with quoted JSON key and colon only.
+---------------------------------------------------------------------------------------------------
+function M.json_bare_key(label)
+    return '"' .. cpp_escape('"' .. json_escape(label) .. '":') .. '"'
+end
+
+---------------------------------------------------------------------------------------------------
+-- Set literal keys of JSON records, with the leading brace or comma. Records with a null check
+-- and no null value are skipped when null. While leading records may be skipped, the brace has to
+-- be written on its own, and the comma of the following record is written unless all of them were
+-- skipped. The comma expression uses <string> and <mr> placeholders. Returns the number of leading
+-- records that may be skipped.
+---------------------------------------------------------------------------------------------------
+function M.json_literal_keys(records)
+    local skipped = 0
+    while records[skipped + 1] and records[skipped + 1].nullcheck and not records[skipped + 1].nullvalue do
+        skipped = skipped + 1
+    end
+    local nullchecks = {}
+    for i, r in ipairs(records) do
+        if skipped == 0 or i > skipped + 1 then
+            r.key = M.json_key(r.label, i == 1)
+        elseif i == 1 then
+            r.key = M.json_bare_key(r.label)
+        else
+            r.key = '<string>(' .. table.concat(nullchecks, ' && ') .. ' ? "" : ","<mr>) + ' .. M.json_bare_key(r.label)
+        end
+        table.insert(nullchecks, r.nullcheck)
+    end
+    return skipped
+end
+
+---------------------------------------------------------------------------------------------------
+-- Return the size of a quoted JSON key followed by colon.
+---------------------------------------------------------------------------------------------------
+function M.json_key_size(label)
+    return string.len(json_escape(label)) + 3
+end
+
+---------------------------------------------------------------------------------------------------
+-- Return the text of a character or string literal expression, suitable for embedding into a
+-- string literal. Returns nil for any other expression.
+---------------------------------------------------------------------------------------------------
+function M.literal_text(expr)
+    local text = string.match(expr, "^'(.+)'$") or string.match(expr, '^"(.*)"$')
+    if text == '"' then
+        return '\\"'
+    end
+    return text
+end
+
+-- Return the run time length of C++ string literal contents, counting each escape sequence as one character.
+local function unescaped_length(text)
+    return string.len((string.gsub(text, '\\.', '_')))
+end
+
+---------------------------------------------------------------------------------------------------
+-- Return the run time text size of a character, string, integer or null pointer literal expression.
+-- Returns nil for any other expression.
+---------------------------------------------------------------------------------------------------
+function M.literal_size(expr)
+    local text = string.match(expr, "^'(.+)'$") or string.match(expr, '^"(.*)"$')
+    if text then
+        return unescaped_length(text)
+    end
+    if string.match(expr, '^[-+]?%d+$') or string.match(expr, '^0[xX]%x+$') then
+        return string.len(string.format('%d', tonumber(expr)))
+    end
+    if expr == 'nullptr' then
+        return 4
+    end
+    return nil
+end
+
+---------------------------------------------------------------------------------------------------
+-- Return the total run time size and the number of string literals embedded in an expression.
+---------------------------------------------------------------------------------------------------
+function M.embedded_literals_size(expr)
+    local size, count = 0, 0
+    for text in string.gmatch(expr, '"(.-[^\\])"') do
+        size  = size + unescaped_length(text)
+        count = count + 1
+    end
+    return size, count
+end
+
 ---------------------------------------------------------------------------------------------------
 -- Convert multiple tables of items into a single table of items.
 ---------------------------------------------------------------------------------------------------
@@ -125,6 +396,7 @@ function M.apply(sub, str)
     result = string.gsub(result, "<separator>",      sub['separator']      or '')
     result = string.gsub(result, "<declaration>",    sub['declaration']    or '')
     result = string.gsub(result, "<specialization>", sub['specialization'] or '')
+    result = string.gsub(result, "<likely>",         sub['likely']         or '')
 
     result = string.gsub(result, "<squote>",         sub['squote']         or squote)
     result = string.gsub(result, "<dquote>",         sub['dquote']         or dquote)
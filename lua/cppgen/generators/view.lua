@@ -0,0 +1,352 @@
+local ast = require('cppgen.ast')
+local log = require('cppgen.log')
+local utl = require('cppgen.generators.util')
+
+---------------------------------------------------------------------------------------------------
+-- Zero-copy view generator. A view wraps a pointer to the raw bytes of a message and reads
+-- fields at their offsets without copying the whole message into a class instance.
+---------------------------------------------------------------------------------------------------
+
+---------------------------------------------------------------------------------------------------
+-- Global parameters for code generation. Initialized in setup.
+---------------------------------------------------------------------------------------------------
+local G = {}
+
+---------------------------------------------------------------------------------------------------
+-- Private parameters for code generation.
+---------------------------------------------------------------------------------------------------
+local P = {}
+
+-- Apply parameters to the format string
+local function apply(format)
+    format = string.gsub(format, "<viewname>", P.viewname or '')
+    format = string.gsub(format, "<returntype>", P.returntype or '')
+    format = string.gsub(format, "<nullcheck>", P.nullcheck or '')
+    format = string.gsub(format, "<nullvalue>", P.nullvalue or '')
+    format = string.gsub(format, "<key>", P.key or '')
+    format = string.gsub(format, "<string>", P.string or '')
+    format = string.gsub(format, "<empty>", P.empty or '')
+    format = string.gsub(format, "<resource>", P.resource or '')
+    format = string.gsub(format, "<mr>", P.mr or '')
+
+    return utl.apply(P, format)
+end
+
+-- Calculate the longest length of a given record member
+local function max_length(records, member)
+    local max_len = 0
+    for _, r in ipairs(records) do
+        max_len = math.max(max_len, string.len(r[member] or ''))
+    end
+    return max_len
+end
+
+-- Return the type node of a field node
+local function type_node(node)
+    for _, c in ipairs(node.children or {}) do
+        if c.role == "type" then
+            return c
+        end
+    end
+    return nil
+end
+
+-- Collect fields of a class type node. Fields of class type may be read through nested views.
+-- C array fields are read as text when they hold characters, or copied into a std::array.
+local function fields(node)
+    local records = {}
+    ast.visit_children(node,
+        function(n)
+            if not ast.anonymous(n) and (n.kind == "Field" or n.kind == "IndirectField") then
+                local record = {}
+                local tn     = type_node(n)
+                record.field = ast.name(n)
+                record.type  = ast.type(n)
+                local element = string.match(record.type or '', '^([^%(]-)%s*%[')
+                if element then
+                    local _, rank = string.gsub(record.type, '%[', '')
+                    local scalar  = string.gsub(string.gsub(element, '^const ', ''), '^volatile ', '')
+                    record.text   = rank == 1 and scalar == 'char'
+                    record.array  = not record.text
+                elseif record.type and G.class.view.nested(record.type, tn ~= nil and tn.kind == "Record") then
+                    record.nested = G.class.view.name(record.type)
+                end
+                table.insert(records, record)
+            end
+            return true
+        end
+    )
+    return records
+end
+
+-- Generate view class with one getter per field.
+local function view_class_lines(node, records)
+    for _, r in ipairs(records) do
+        if r.text then
+            r.returntype = 'std::string_view'
+        elseif r.array then
+            r.returntype = 'array<decltype(' .. P.classname .. '::' .. r.field .. ')>'
+        else
+            r.returntype = r.nested or 'decltype(' .. P.classname .. '::' .. r.field .. ')'
+        end
+    end
+    local maxflen = max_length(records, 'field')
+    local maxrlen = max_length(records, 'returntype')
+    local hastext = false
+    local hasarr  = false
+    for _, r in ipairs(records) do
+        hastext = hastext or r.text
+        hasarr  = hasarr or r.array
+    end
+    local lines   = {}
+
+    table.insert(lines, apply('class <attribute> <viewname>'))
+    table.insert(lines, apply('{'))
+    -- Multidimensional arrays are flattened
+    if hasarr then
+        table.insert(lines, apply('<indent>template<typename T>'))
+        table.insert(lines, apply('<indent>using array = std::array<std::remove_all_extents_t<T>, sizeof(T) / sizeof(std::remove_all_extents_t<T>)>;'))
+        table.insert(lines, apply(''))
+    end
+    table.insert(lines, apply('public:'))
+    table.insert(lines, apply('<indent>explicit <viewname>(const char* data)'))
+    table.insert(lines, apply('<indent><indent>: data_(data)'))
+    table.insert(lines, apply('<indent>{'))
+    table.insert(lines, apply('<indent>}'))
+    table.insert(lines, apply(''))
+    table.insert(lines, apply('<indent>const char* data() const { return data_; }'))
+    table.insert(lines, apply('<indent>static constexpr std::size_t size() { return sizeof(<classname>); }'))
+    table.insert(lines, apply(''))
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format off'))
+    end
+    for _, r in ipairs(records) do
+        P.fieldname  = r.field
+        P.returntype = r.returntype
+        P.labelpad   = string.rep(' ', maxrlen - string.len(r.returntype))
+        P.valuepad   = string.rep(' ', maxflen - string.len(r.field))
+        if r.nested then
+            table.insert(lines, apply('<indent><returntype><labelpad> <fieldname>() const<valuepad> { return <returntype>(data_ + offsetof(<classname>, <fieldname>)); }'))
+        elseif r.text then
+            table.insert(lines, apply('<indent><returntype><labelpad> <fieldname>() const<valuepad> { return text(offsetof(<classname>, <fieldname>), sizeof(<classname>::<fieldname>)); }'))
+        else
+            table.insert(lines, apply('<indent><returntype><labelpad> <fieldname>() const<valuepad> { return load<<returntype>>(offsetof(<classname>, <fieldname>)); }'))
+        end
+    end
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format on'))
+    end
+    table.insert(lines, apply(''))
+    table.insert(lines, apply('private:'))
+    table.insert(lines, apply('<indent>template<typename T>'))
+    table.insert(lines, apply('<indent>T load(std::size_t offset) const'))
+    table.insert(lines, apply('<indent>{'))
+    table.insert(lines, apply('<indent><indent>static_assert(std::is_trivially_copyable_v<T>, "View fields must be trivially copyable");'))
+    table.insert(lines, apply('<indent><indent>T v;'))
+    table.insert(lines, apply('<indent><indent>std::memcpy(&v, data_ + offset, sizeof(v));'))
+    table.insert(lines, apply('<indent><indent>return v;'))
+    table.insert(lines, apply('<indent>}'))
+    table.insert(lines, apply(''))
+    -- Character arrays are padded with null characters
+    if hastext then
+        table.insert(lines, apply('<indent>std::string_view text(std::size_t offset, std::size_t size) const'))
+        table.insert(lines, apply('<indent>{'))
+        table.insert(lines, apply('<indent><indent>const char* p = data_ + offset;'))
+        table.insert(lines, apply('<indent><indent>return std::string_view(p, std::find(p, p + size, \'\\0\') - p);'))
+        table.insert(lines, apply('<indent>}'))
+        table.insert(lines, apply(''))
+    end
+    table.insert(lines, apply('<indent>const char* data_;'))
+    table.insert(lines, apply('};'))
+    return lines
+end
+
+-- Generate output stream shift operator for the view, using the class shift operator options.
+local function view_shift_lines(node, records)
+    local lines = {}
+    for _, r in ipairs(records) do
+        r.label = G.class.shift.label(ast.name(node), r.field, utl.camelize(r.field))
+        r.value = G.class.shift.value('o.' .. r.field .. '()', r.type)
+    end
+    local maxllen = max_length(records, 'label')
+    local maxvlen = max_length(records, 'value')
+
+    P.separator = G.class.shift.separator
+
+    table.insert(lines, apply('inline <attribute> std::ostream& operator<<(std::ostream& s, const <viewname>& o)'))
+    table.insert(lines, apply('{'))
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format off'))
+    end
+    if G.class.shift.preamble then
+        table.insert(lines, apply('<indent>s << "' .. G.class.shift.preamble(P.classname) .. '";'))
+    end
+    for i, r in ipairs(records) do
+        P.label    = r.label
+        P.value    = r.value
+        P.labelpad = string.rep(' ', maxllen - string.len(r.label))
+        P.valuepad = string.rep(' ', maxvlen - string.len(r.value))
+        if i == #records then
+            table.insert(lines, apply('<indent>s << "<label>"<labelpad> << <value>;'))
+        else
+            table.insert(lines, apply('<indent>s << "<label>"<labelpad> << <value><valuepad> << <separator>;'))
+        end
+    end
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format on'))
+    end
+    table.insert(lines, apply('<indent>return s;'))
+    table.insert(lines, apply('}'))
+    return lines
+end
+
+-- Generate JSON serialization for the view, using the class JSON options. Keys are literal or
+-- serialized, and fields with a null check and no null value are skipped when null, as for the
+-- class. The allocator aware variant returns strings allocated from the memory resource passed as
+-- the last parameter.
+local function view_json_lines(node, records, pmr)
+    P.string   = pmr and 'std::pmr::string' or 'std::string'
+    P.empty    = pmr and 'std::pmr::string(mr)' or 'std::string()'
+    P.resource = pmr and ', std::pmr::memory_resource* mr' or ''
+    P.mr       = pmr and ', mr' or ''
+
+    local lines   = {}
+    local entries = {}
+    for _, r in ipairs(records) do
+        local fieldref = 'o.' .. r.field .. '()'
+        local label    = G.class.json.label(ast.name(node), r.field, utl.camelize(r.field))
+        local value    = label and G.class.json.value(fieldref, r.type)
+        if value then
+            local entry = { label = label, value = value }
+            if G.class.json.nullcheck and utl.nullable(r.type, G.nullability) then
+                entry.nullcheck = G.class.json.nullcheck(fieldref, r.type)
+                entry.nullvalue = G.class.json.nullvalue and G.class.json.nullvalue(fieldref, r.type)
+            end
+            table.insert(entries, entry)
+        end
+    end
+    local literal = G.class.json.literalkeys
+    local skipped = literal and utl.json_literal_keys(entries) or 0
+    local maxklen = max_length(entries, literal and 'key' or 'label')
+    local maxclen = max_length(entries, 'nullcheck')
+    local maxvlen = max_length(entries, 'value')
+    local key     = literal and '<key><labelpad>' or '<functionname>("<label>"<mr>)<labelpad> + <colon>'
+
+    P.functionname = G.class.json.name
+
+    table.insert(lines, apply('inline <attribute> <string> <functionname>(const <viewname>& o, bool verbose<resource>)'))
+    table.insert(lines, apply('{'))
+    table.insert(lines, apply('<indent>return <empty>'))
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format off'))
+    end
+    if not literal or #entries == 0 or skipped > 0 then
+        table.insert(lines, apply('<indent>+ "{"'))
+    end
+    for i, e in ipairs(entries) do
+        local separator = (literal or i == #entries) and '' or ' + <comma>'
+        P.label     = e.label
+        P.key       = e.key
+        P.labelpad  = string.rep(' ', maxklen - string.len(e.key or e.label))
+        P.value     = e.value
+        P.valuepad  = string.rep(' ', maxvlen - string.len(e.value))
+        P.nullcheck = e.nullcheck and e.nullcheck .. string.rep(' ', maxclen - string.len(e.nullcheck))
+        P.nullvalue = e.nullvalue
+        if e.nullcheck and e.nullvalue then
+            table.insert(lines, apply('<indent>+ ' .. key .. ' + (<nullcheck> ? <functionname>(<nullvalue>, verbose<mr>) : <functionname>(<value><valuepad>, verbose<mr>))' .. separator))
+        elseif e.nullcheck then
+            table.insert(lines, apply('<indent>+ (<nullcheck> ? "" : ' .. key .. ' + <functionname>(<value><valuepad>, verbose<mr>))' .. separator))
+        else
+            table.insert(lines, apply('<indent>+ ' .. key .. ' + <functionname>(<value><valuepad>, verbose<mr>)' .. separator))
+        end
+    end
+    table.insert(lines, apply('<indent>+ "}";'))
+    if G.keepindent then
+        table.insert(lines, apply('<indent>// clang-format on'))
+    end
+    table.insert(lines, apply('}'))
+    return lines
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate view class for a class type node, followed by the printers enabled for the class.
+-- Fields are read with memcpy at their offsets, so the buffer does not need to be aligned.
+---------------------------------------------------------------------------------------------------
+local function view_snippet(node, alias)
+    log.debug("view_snippet:", ast.details(node))
+
+    P.attribute = G.attribute and ' ' .. G.attribute or ''
+    P.classname = alias and ast.name(alias) or ast.name(node)
+    P.viewname  = G.class.view.name(P.classname)
+    P.indent    = string.rep(' ', vim.lsp.util.get_effective_tabstop())
+
+    local records = fields(node)
+    local lines   = view_class_lines(node, records)
+
+    if G.class.shift.enabled then
+        utl.append(lines, view_shift_lines(node, records))
+    end
+    if G.class.json.enabled then
+        utl.append(lines, view_json_lines(node, records, false))
+        if G.pmr.enabled then
+            utl.append(lines, view_json_lines(node, records, true))
+        end
+    end
+
+    for _, l in ipairs(lines) do log.debug(l) end
+    return lines
+end
+
+---------------------------------------------------------------------------------------------------
+--- Public interface.
+---------------------------------------------------------------------------------------------------
+local M = {}
+
+---------------------------------------------------------------------------------------------------
+--- Generator will call this method to get kind of nodes that are of interest to each generator.
+---------------------------------------------------------------------------------------------------
+function M.digs()
+    log.trace("digs:")
+    return { "CXXRecord" }
+end
+
+---------------------------------------------------------------------------------------------------
+-- Generate completion items. The view refers to the class members, so it is only generated
+-- outside of the class.
+---------------------------------------------------------------------------------------------------
+function M.generate(node, alias, scope, acceptor)
+    log.trace("generate:", ast.details(node))
+
+    if G.class.view.enabled and scope ~= ast.Class and ast.is_class(node) and not ast.is_class_template(node) then
+        acceptor({ name = G.class.view.name(alias and ast.name(alias) or ast.name(node)), trigger = G.class.view.trigger, lines = view_snippet(node, alias) })
+    end
+end
+
+---------------------------------------------------------------------------------------------------
+--- Info callback
+---------------------------------------------------------------------------------------------------
+function M.info()
+    log.trace("info")
+    local info = {}
+
+    if G.class.view.enabled then
+        table.insert(info, { G.class.view.trigger, "Class zero-copy view over raw message bytes" })
+    end
+
+    return info
+end
+
+---------------------------------------------------------------------------------------------------
+--- Initialization callback. Capture relevant parts of the configuration.
+---------------------------------------------------------------------------------------------------
+function M.setup(opts)
+    log.trace("setup")
+    G.keepindent  = opts.keepindent
+    G.attribute   = opts.attribute
+    G.nullability = opts.nullability
+    G.class       = opts.class
+    G.pmr         = opts.pmr
+    log.trace("setup:", G)
+end
+
+return M
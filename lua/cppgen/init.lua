@@ -10,11 +10,33 @@ local M = {}
 local cppgen = 'cppgen'
 local csrcid = nil
 
---- LSP attach callback
-local function attach(client, bufnr)
-    log.info("Client", log.squoted(client.name), "attached to", log.squoted(vim.api.nvim_buf_get_name(bufnr)))
+-- Identifiers of clients attached to buffers
+local clients = {}
+
+-- Check if the client can serve the provider. Clangd provider needs AST data, other providers only
+-- resolve types through the client.
+local function capable(client, provider)
+    if provider == 'clangd' then
+        return client.server_capabilities.astProvider
+    end
+    return client.server_capabilities.typeDefinitionProvider
+end
 
-	cgn.attached(client, bufnr)
+-- Check if the client should replace the one already attached to the buffer. A capable client is
+-- kept, unless the new one is clangd.
+local function preferred(client, bufnr)
+    local current = clients[bufnr] and vim.lsp.get_client_by_id(clients[bufnr])
+    return current == nil or (client.name == 'clangd' and current.name ~= 'clangd')
+end
+
+--- LSP attach callback. Client is nil when the buffer is attached on behalf of the tree-sitter provider.
+local function attach(client, bufnr)
+    if client then
+        log.info("Client", log.squoted(client.name), "attached to", log.squoted(vim.api.nvim_buf_get_name(bufnr)))
+        cgn.attached(client, bufnr)
+    else
+        log.info("Attached to", log.squoted(vim.api.nvim_buf_get_name(bufnr)), "without a client")
+    end
 
 	local group = vim.api.nvim_create_augroup(cppgen, { clear = false })
 
@@ -44,6 +66,14 @@ local function attach(client, bufnr)
 		group  = group,
 		buffer = bufnr
 	})
+	vim.api.nvim_create_autocmd({ "BufWipeout" }, {
+		callback = function(args)
+			clients[bufnr] = nil
+			cgn.wiped(bufnr)
+		end,
+		group  = group,
+		buffer = bufnr
+	})
 
     -- Add our source to cmp
     if not csrcid then
@@ -67,12 +97,23 @@ function M.setup(opts)
             if vim.bo.filetype == "cpp" then
 			    local client = vim.lsp.get_client_by_id(args.data.client_id)
                 log.info("Attached:", log.squoted(client.name), "which", client.server_capabilities.astProvider and "is" or "is not", "capable of delivering AST data.")
-	            if client.server_capabilities.astProvider then
+	            if capable(client, options.provider) and preferred(client, args.buf) then
+				    clients[args.buf] = client.id
 				    attach(client, args.buf)
 			    end
 			end
 		end,
 	})
+
+    -- Other AST providers do not need a language server, the client is only used to resolve types
+    if options.provider ~= 'clangd' then
+        vim.api.nvim_create_autocmd("FileType", {
+            pattern  = "cpp",
+            callback = function(args)
+                attach(nil, args.buf)
+            end,
+        })
+    end
 end
 
 return M
@@ -2,31 +2,184 @@ local ast = require('cppgen.ast')
 local log = require('cppgen.log')
 
 ---------------------------------------------------------------------------------------------------
---- LSP utilities
+--- LSP utilities. Requests are made from coroutines: an awaitable request suspends the calling
+--- coroutine until the response arrives, and a counting semaphore bounds the number of requests in
+--- flight, so that batch mode does not flood the server. Callback style wrappers are provided for
+--- callers outside of coroutines.
 ---------------------------------------------------------------------------------------------------
 
+---------------------------------------------------------------------------------------------------
+-- Global parameters. Initialized in setup.
+---------------------------------------------------------------------------------------------------
+local G = {
+    inflight = 8,
+    timeout  = 10000,
+}
+
+---------------------------------------------------------------------------------------------------
+-- Local parameters. Requests in flight and coroutines waiting for a free slot, in arrival order.
+---------------------------------------------------------------------------------------------------
+local L = {
+    inflight = 0,
+    waiting  = {},
+}
+
 local M = {}
 
+-- Observer of successful responses, used to record fixtures
+local observer = nil
+
+-- Resume a suspended coroutine, logging errors raised in it
+local function resume(co, ...)
+    local ok, err = coroutine.resume(co, ...)
+    if not ok then
+        log.error(err)
+    end
+end
+
+-- Take a request slot, waiting for one to be released if all are taken
+local function acquire()
+    if L.inflight >= G.inflight then
+        local co = coroutine.running()
+        table.insert(L.waiting, co)
+        coroutine.yield()
+    end
+    L.inflight = L.inflight + 1
+end
+
+-- Release a request slot and wake up the longest waiting coroutine
+local function release()
+    L.inflight = L.inflight - 1
+    local co = table.remove(L.waiting, 1)
+    if co then
+        resume(co)
+    end
+end
+
 ---------------------------------------------------------------------------------------------------
---- Get AST for the whole buffer and invoke callback on it.
+--- Set the function invoked with method, parameters and result of every successful response.
 ---------------------------------------------------------------------------------------------------
-function M.get_ast(client, callback, location)
+function M.observe(f)
+    observer = f
+end
+
+---------------------------------------------------------------------------------------------------
+--- Run the function in a new coroutine. It runs synchronously until its first wait.
+---------------------------------------------------------------------------------------------------
+function M.async(f, ...)
+    resume(coroutine.create(f), ...)
+end
+
+---------------------------------------------------------------------------------------------------
+--- Run each function in its own coroutine and wait until all of them return. Results are returned
+--- in the order of the functions, regardless of the order of completion. Functions that raise an
+--- error are logged and have nil result. Must be called from a coroutine.
+---------------------------------------------------------------------------------------------------
+function M.all(fs)
+    local co      = coroutine.running()
+    local results = {}
+    local pending = #fs
+    local waiting = false
+    for i, f in ipairs(fs) do
+        M.async(function()
+            local ok, result = pcall(f)
+            if ok then
+                results[i] = result
+            else
+                log.error(result)
+            end
+            pending = pending - 1
+            if pending == 0 and waiting then
+                resume(co)
+            end
+        end)
+    end
+    if pending > 0 then
+        waiting = true
+        coroutine.yield()
+    end
+    return results
+end
+
+---------------------------------------------------------------------------------------------------
+--- Send a request and wait for the response. Returns error and result. Must be called from a
+--- coroutine.
+---------------------------------------------------------------------------------------------------
+function M.request(client, method, params)
+    local co = coroutine.running()
+    assert(co, "lsp.request must be called from a coroutine")
+
+    acquire()
+
+    local done, waiting = false, false
+    local rerr, rresult = nil, nil
+    local timer         = nil
+    -- Resume with the first of response and timeout, ignoring the other. The timer is released right away, so
+    -- answered requests do not keep it alive until the timeout.
+    local function complete(err, result)
+        if done then
+            return
+        end
+        rerr, rresult, done = err, result, true
+        if timer and not timer:is_closing() then
+            timer:stop()
+            timer:close()
+        end
+        if waiting then
+            resume(co)
+        end
+    end
+    local ok, id = client.request(method, params, function(err, result, _)
+        complete(err, result)
+    end)
+    -- Stopped clients reject the request and never call the handler
+    if not ok then
+        release()
+        return { message = "Request " .. method .. " was not sent" }, nil
+    end
+    -- Response may have been delivered synchronously
+    if not done then
+        timer = vim.defer_fn(function()
+            if not done and client.cancel_request and id then
+                client.cancel_request(id)
+            end
+            complete({ message = "Request " .. method .. " timed out" }, nil)
+        end, G.timeout)
+        waiting = true
+        coroutine.yield()
+    end
+
+    release()
+
+    if rerr == nil and observer then
+        observer(method, params, rresult)
+    end
+    return rerr, rresult
+end
+
+---------------------------------------------------------------------------------------------------
+--- Get AST for the whole buffer, or for the document at the given location. Returns nil on error.
+--- Must be called from a coroutine.
+---------------------------------------------------------------------------------------------------
+function M.ast(client, location)
 	local params = { textDocument = vim.lsp.util.make_text_document_params() }
     if location then
         params.textDocument.uri = location.uri
     end
-    if client then
-        log.trace("Requesting AST for current buffer")
-	    client.request("textDocument/ast", params, function(err, symbols, _)
-            if err ~= nil then
-                log.error(err)
-            else
-                log.info("Received AST data with", (symbols and symbols.children and #symbols.children or 0), "top level nodes")
-                log.trace(symbols)
-                callback(symbols)
-		    end
-	    end)
+    log.trace("Requesting AST for", params.textDocument.uri)
+
+    local err, symbols = M.request(client, "textDocument/ast", params)
+    if err ~= nil then
+        log.error(err)
+        return nil
     end
+    log.info("Received AST data with", (symbols and symbols.children and #symbols.children or 0), "top level nodes")
+    log.trace(symbols)
+
+    -- Response tables are released as soon as we return
+    local nodes, count = ast.compact(symbols)
+    log.debug("Compacted", count, "nodes, heap size", collectgarbage('count'), "KB")
+    return nodes
 end
 
 --- Given a symbol tree, find a node whose definition starts at a given range
@@ -39,7 +192,7 @@ local function get_type_definition_node(symbols, range)
             return not node
         end,
         function(n)
-            if n.range and n.range['start'].line == range['start'].line then
+            if ast.lines(n) == range['start'].line then
                 node = n
             end
         end
@@ -47,48 +200,71 @@ local function get_type_definition_node(symbols, range)
     return node
 end
 
---- Given a condition node location, request the AST for it
-local function get_type_ast(client, location, callback)
-    log.trace("get_type_ast:", location)
+---------------------------------------------------------------------------------------------------
+--- Given a node, request the type information for it and return the type definition node, nil if
+--- the type can not be resolved. Must be called from a coroutine.
+---------------------------------------------------------------------------------------------------
+function M.type_definition(client, node)
+    log.trace("type_definition:", ast.details(node))
+    local params = vim.lsp.util.make_position_params();
+
+    params.position.line      = node.range.start.line
+    params.position.character = node.range.start.character
+    log.trace("type_definition:", "params", params)
 
-	local params = { textDocument = vim.lsp.util.make_text_document_params() }
-    params.textDocument.uri = location.uri
+    local err, locations = M.request(client, "textDocument/typeDefinition", params)
+    if err ~= nil then
+        log.error(err)
+        return nil
+    end
+    if locations == nil or next(locations) == nil then
+        return nil
+    end
+    local location = locations[1]
 
     -- In case the definition is in different file
     local cb = vim.api.nvim_get_current_buf()
     vim.cmd.edit(location.uri)
     vim.api.nvim_set_current_buf(cb)
 
-	client.request("textDocument/ast", params, function(err, symbols, _)
-        if err ~= nil then
-            log.error(err)
-        else
-            local node = get_type_definition_node(symbols, location.range)
-            if node then
-                callback(node)
-	        end
-	    end
-	end)
+    local symbols = M.ast(client, location)
+    return symbols and get_type_definition_node(symbols, location.range)
+end
+
+---------------------------------------------------------------------------------------------------
+--- Get AST for the whole buffer and invoke callback on it.
+---------------------------------------------------------------------------------------------------
+function M.get_ast(client, callback, location)
+    if client then
+        M.async(function()
+            local symbols = M.ast(client, location)
+            if symbols then
+                callback(symbols)
+            end
+        end)
+    end
 end
 
---- Given a node, request the type information for it using supplied client and invoke the givan callback
+---------------------------------------------------------------------------------------------------
+--- Given a node, request the type information for it using supplied client and invoke the given
+--- callback on the type definition node.
+---------------------------------------------------------------------------------------------------
 function M.get_type_definition(client, node, callback)
-    log.trace("get_type_definition:", ast.details(node))
-    local params = vim.lsp.util.make_position_params();
+    M.async(function()
+        local n = M.type_definition(client, node)
+        if n then
+            callback(n)
+        end
+    end)
+end
 
-    params.position.line      = node.range.start.line
-    params.position.character = node.range.start.character
-    log.trace("get_type_definition:", "params", params)
-
-	client.request("textDocument/typeDefinition", params, function(err, symbols, _)
-        if err ~= nil then
-            log.error(err)
-        else
-            if next(symbols) ~= nil then
-                get_type_ast(client, symbols[1], callback)
-            end
-	    end
-	end)
+---------------------------------------------------------------------------------------------------
+--- Initialization callback
+---------------------------------------------------------------------------------------------------
+function M.setup(opts)
+    log.trace("setup")
+    G.inflight = opts.lsp.inflight
+    G.timeout  = opts.lsp.timeout
 end
 
 return M
@@ -41,6 +41,85 @@ M.default = {
     -- Add clang-format on/off guards around parts of generated code.
     keepindent = true,
 
+    -- Field type nullability. Null checks are generated only for fields whose type can hold a null value.
+    nullability = {
+        -- Lua patterns matched against the field type name. Types that match can never be null.
+        nonnull = {
+            '^bool$', '^char$', '^signed char$', '^unsigned char$', '^wchar_t$', '^char8_t$', '^char16_t$', '^char32_t$',
+            '^short$', '^unsigned short$', '^int$', '^unsigned int$', '^unsigned$', '^long$', '^unsigned long$',
+            '^long long$', '^unsigned long long$', '^float$', '^double$', '^long double$',
+            '^u?int%d+_t$', '^std::u?int%d+_t$', '^size_t$', '^std::size_t$',
+        },
+        -- Consulted before the patterns. Return true if the type can be null, false if it can not, nil to use the patterns.
+        nullable = function(type)
+            return nil
+        end,
+    },
+
+    -- Enumerator frequency profile. Generated enum comparisons and case labels are ordered hottest first.
+    profile = {
+        -- CSV file with Enum::Value,count lines, as dumped by an instrumented build. Declaration order is kept when nil.
+        file       = nil,
+        -- Add [[likely]] and [[unlikely]] attributes. Requires C++20.
+        attributes = false,
+        -- Enumerators above this share of the total count are likely.
+        likely     = 0.5,
+        -- Enumerators below this share of the total count are unlikely.
+        unlikely   = 0.01,
+    },
+
+    -- Allocator aware overloads of the generated string returning functions. Enum to_string, and class, view and enum
+    -- to_json get an overload taking std::pmr::memory_resource* as the last parameter and returning std::pmr::string, so
+    -- that an arena or monotonic buffer can back all temporaries of a message.
+    pmr = {
+        -- Disabled by default.
+        enabled = false,
+    },
+
+    -- Source of the AST nodes. Either 'clangd', 'treesitter' or a function(bufnr, callback) invoking the callback with
+    -- a tree of nodes shaped like the clangd textDocument/ast nodes. Tree-sitter parses the buffer locally, and the
+    -- language server, when attached, is only asked to resolve type aliases and switch conditions. Falls back to
+    -- clangd if there is no C++ tree-sitter parser.
+    provider = 'clangd',
+
+    -- User generators, dispatched along with the built-in ones. Each entry is a table with the generator module, given
+    -- by name or as a table implementing digs, generate, info, setup and optionally attached and generate_all, and an
+    -- optional enabled function(opts) predicate. Modules are loaded on first use, only when enabled.
+    -- Example: { module = 'mygen', enabled = function(opts) return opts.mygen.enabled end }
+    generators = {},
+
+    -- Generation state kept per buffer, so that collected snippets survive switching between buffers.
+    buffers = {
+        -- Approximate memory budget in KB for snippets of all buffers. Least recently used buffers are dropped first.
+        budget = 16384,
+    },
+
+    -- Language server requests.
+    lsp = {
+        -- Maximum number of requests in flight. Further requests wait until one of them completes.
+        inflight = 8,
+        -- Milliseconds to wait for a response before the request fails.
+        timeout  = 10000,
+    },
+
+    -- Snippet cache kept across sessions. Snippets of files that did not change since they were cached are offered
+    -- while the AST is still loading. Any change of the file content or of the options invalidates the cache.
+    cache = {
+        -- Disabled by default.
+        enabled   = false,
+        -- Directory of the cache files. When nil, cppgen under stdpath('cache').
+        directory = nil,
+    },
+
+    -- Recorded language server responses, replayed by the generator benchmark instead of a live clangd.
+    fixtures = {
+        -- Directory of the fixture and golden output files. When nil, cppgen/fixtures under stdpath('data'). Fixtures of
+        -- the examples, with golden output of the default options, are in examples/fixtures.
+        directory  = nil,
+        -- Number of benchmark passes over each fixture.
+        iterations = 100,
+    },
+
     -- Batch mode code generation. Will attempt generate code for the whole file
     batchmode = {
         -- Disabled by default.
@@ -50,6 +129,12 @@ M.default = {
         trigger = function(trig)
             return trig .. '!'
         end,
+
+        -- Target file of a group inserted by the batch command, given the group trigger and the source file name.
+        -- The group is appended to the target file buffer. When nil, it is inserted below the cursor.
+        target = function(trig, file)
+            return nil
+        end,
     },
 
     -- Class type snippet generator.
@@ -73,10 +158,57 @@ M.default = {
             end,
             -- Separator between fields.
             separator = "' '",
+            -- Also generate constexpr max_text_size(const T*), the upper bound of the printed text size.
+            maxsize   = false,
             -- Completion trigger. Will also use the first word of the function definition line.
             trigger   = "shift"
         },
 
+        -- Formatting into a fixed size buffer: char* format_to(char* out, char* end, const T& o).
+        -- Produces the same text as the output stream shift operator, using its options.
+        format = {
+            -- Disabled by default.
+            enabled = false,
+
+            -- Name of the formatting function. Also used as a completion trigger.
+            name    = "format_to",
+            -- Additional completion trigger if present.
+            trigger = "format"
+        },
+
+        -- Parsing of the text written by the output stream shift operator: bool parse(std::string_view s, T& o).
+        -- Uses the shift operator preamble, label and separator options. Separator must be a literal. Field values
+        -- are parsed into the fields directly, so the shift value option is expected to print the field as is.
+        parse = {
+            -- Disabled by default.
+            enabled = false,
+
+            -- Name of the parsing function. Also used as a completion trigger.
+            name    = "parse",
+            -- Additional completion trigger if present.
+            trigger = "parse"
+        },
+
+        -- FIX tag=value encoder: char* to_fix(char* out, const T& o, unsigned& checksum). Writes tag=value<SOH> for
+        -- each tagged field and adds the written bytes to the checksum. Header and trailer are left to the caller.
+        fix = {
+            -- Disabled by default.
+            enabled = false,
+
+            -- FIX tag of the field, number or string. Fields without a tag are skipped, except nested fields.
+            tag = function(classname, fieldname, camelized)
+                return nil
+            end,
+            -- Untagged fields of class type for which this returns true are written in place using their own encoder.
+            nested = function(type)
+                return false
+            end,
+            -- Name of the encoding function. Also used as a completion trigger.
+            name    = "to_fix",
+            -- Additional completion trigger if present.
+            trigger = "fix"
+        },
+
         -- JSON serialization
         json = {
             -- Enabled by default.
@@ -99,6 +231,18 @@ M.default = {
                 return 'nullptr'
             end,
 
+            -- Serialize fields that are never null first, as one run without null check branches.
+            groupnonnull = false,
+
+            -- Emit keys as string literals that include quotes, colon and the preceding comma, instead of converting labels at run time.
+            literalkeys = true,
+
+            -- Emit a template on the verbosity, taking std::true_type or std::false_type, and a wrapper taking the runtime flag.
+            compiletime = false,
+
+            -- Also generate constexpr max_json_size(const T*), the upper bound of the serialized text size.
+            maxsize = false,
+
             -- Name of the conversion function. Also used as a completion trigger.
             name = "to_json",
 
@@ -126,11 +270,114 @@ M.default = {
             nullvalue = function(fieldref, type)
                 return 'nullptr'
             end,
+            -- Binary archive fast path. Qualifying classes are saved and loaded with a single cereal::binary_data call
+            -- by cereal::BinaryOutputArchive and cereal::BinaryInputArchive, while all other archives keep using named fields.
+            -- Generated code names these archives, so <cereal/archives/binary.hpp> has to be included.
+            binary = {
+                -- Disabled by default.
+                enabled = false,
+                -- Decide if the class qualifies. The packed flag is set when the AST shows the class as packed.
+                qualifies = function(classname, packed)
+                    return packed
+                end,
+            },
             -- Name of the conversion function. Also used as a completion trigger.
             name = "save",
             -- Additional completion trigger if present.
             trigger = "arch"
         },
+
+        -- Field-wise comparison and hashing.
+        compare = {
+            -- Equality and inequality operators.
+            equal = {
+                -- Disabled by default.
+                enabled = false,
+                -- Completion trigger.
+                trigger = "equal"
+            },
+            -- Difference function. Returns a bit mask with N-th bit set when the N-th field differs.
+            diff = {
+                -- Disabled by default.
+                enabled = false,
+                -- Name of the difference function. Also used as a completion trigger.
+                name    = "diff",
+                -- Additional completion trigger if present.
+                trigger = "diff"
+            },
+            -- Hash function.
+            hash = {
+                -- Disabled by default.
+                enabled = false,
+                -- Hash of a single field. Field hashes are combined into the class hash. Return 'hash_value(' .. fieldref
+                -- .. ')' to hash nested classes with their generated hash functions instead of std::hash.
+                value   = function(fieldref, type)
+                    return 'std::hash<std::decay_t<decltype(' .. fieldref .. ')>>{}(' .. fieldref .. ')'
+                end,
+                -- Name of the hash function. Also used as a completion trigger.
+                name    = "hash_value",
+                -- Additional completion trigger if present.
+                trigger = "hash"
+            },
+            -- Compare and hash the object representation instead of the fields. The packed flag is set when the AST
+            -- shows the class as packed. Requires unique object representations, which rules out floating point fields.
+            bytewise = function(classname, packed)
+                return false
+            end,
+        },
+
+        -- Struct of arrays container holding each field in its own contiguous vector.
+        columns = {
+            -- Disabled by default.
+            enabled = false,
+
+            -- Name of the container type.
+            name    = function(classname)
+                return classname .. 'Columns'
+            end,
+            -- Completion trigger.
+            trigger = "columns"
+        },
+
+        -- Zero-copy view reading fields from raw message bytes. Output stream shift operator and JSON serialization
+        -- are generated for the view when enabled for classes.
+        view = {
+            -- Disabled by default.
+            enabled = false,
+
+            -- Name of the view type. Character arrays are read as std::string_view and other C arrays are copied into a
+            -- flat std::array.
+            name    = function(classname)
+                return classname .. 'View'
+            end,
+            -- Return true to read a field through the view of its type, which has to be generated as well. The record
+            -- flag is set for class types.
+            nested  = function(type, record)
+                return false
+            end,
+            -- Completion trigger.
+            trigger = "view"
+        },
+
+        -- Message dispatcher, generated in batch mode from all message classes in the file. A message class has a
+        -- header field and declares the discriminator enumerator, e.g. enum : std::uint8_t { type = 'D' };
+        dispatch = {
+            -- Disabled by default.
+            enabled       = false,
+
+            -- Name of the header type.
+            header        = 'Header',
+            -- Name of the header field holding the message type. Also the name of the message class enumerator.
+            discriminator = 'type',
+            -- Expression for the message size given by the header object.
+            size          = function(header)
+                return header .. '.size()'
+            end,
+            -- Name of the dispatch function. Also used as a completion trigger.
+            name          = "dispatch",
+            -- Additional completion trigger if present.
+            trigger       = "dispatch"
+        },
     },
 
     -- Enum type snippet generator.
@@ -155,10 +402,47 @@ M.default = {
             end,
             -- May use to_string function
             to_string = false,
+            -- Also generate constexpr max_text_size(const T*), the upper bound of the printed text size.
+            maxsize = false,
             -- Completion trigger. Will also use the first word of the function definition line.
             trigger = "shift"
         },
 
+        -- Formatting into a fixed size buffer: char* format_to(char* out, char* end, enum e).
+        -- Produces the same text as the output stream shift operator, using its options.
+        format = {
+            -- Disabled by default.
+            enabled = false,
+
+            -- Name of the formatting function. Also used as a completion trigger.
+            name    = "format_to",
+            -- Additional completion trigger if present.
+            trigger = "format"
+        },
+
+        -- Parsing of the text written by the output stream shift operator: bool parse(std::string_view v, enum& o).
+        -- Compares against the strings produced by the shift value option. Default case text is not parsed.
+        parse = {
+            -- Disabled by default.
+            enabled = false,
+
+            -- Name of the parsing function. Also used as a completion trigger.
+            name    = "parse",
+            -- Additional completion trigger if present.
+            trigger = "parse"
+        },
+
+        -- FIX value writer: char* to_fix(char* out, enum o). Writes the enumerator value, used by the class encoders.
+        fix = {
+            -- Disabled by default.
+            enabled = false,
+
+            -- Name of the encoding function. Also used as a completion trigger.
+            name    = "to_fix",
+            -- Additional completion trigger if present.
+            trigger = "fix"
+        },
+
         -- To string conversion function: std::string to_string(enum e).
         to_string = {
             -- Enabled by default.
@@ -223,14 +507,22 @@ M.default = {
                 end,
                 --]]
 
-                -- Error type that will be passed from the conversion function.
-                errortype = 'std::string',
+                -- Error type that will be passed from the conversion function. Error code enum, so that failed
+                -- conversions do not allocate. Requires <system_error>.
+                errortype = 'std::errc',
 
                 -- Error expression returned if conversion fails.
+                error = function(classname, value)
+                    return 'std::errc::invalid_argument'
+                end,
+                -- Descriptive message instead, at the cost of an allocation.
+                --[[
+                errortype = 'std::string',
                 error = function(classname, value)
                     return '"Value " + std::string(' ..
                         value .. ') + " is outside of ' .. classname .. ' enumeration range."'
                 end,
+                --]]
             },
             -- From integer conversion. Specializations of: template <typename T> T enum_cast(int v).
             from_integer = {
@@ -248,13 +540,13 @@ M.default = {
                 -- Enabled by default.
                 enabled = true,
 
-                -- Error type that will be passed from the conversion function.
-                errortype = 'std::string',
+                -- Error type that will be passed from the conversion function. Error code enum, so that failed
+                -- conversions do not allocate. Requires <system_error>.
+                errortype = 'std::errc',
 
-                -- Exception expression thrown if conversion fails.
+                -- Error expression returned if conversion fails.
                 error = function(classname, value)
-                    return '"Value " + std::to_string(' ..
-                        value .. ') + " is outside of ' .. classname .. ' enumeration range."'
+                    return 'std::errc::result_out_of_range'
                 end,
             },
             -- Name of the conversion function. Also used as a completion trigger.
@@ -298,6 +590,13 @@ M.default = {
                 end,
             },
 
+            -- Emit a template on the verbosity, with terse and verbose switches selected by if constexpr, and a wrapper
+            -- taking the runtime flag.
+            compiletime = false,
+
+            -- Also generate constexpr max_json_size(const T*), the upper bound of the serialized text size.
+            maxsize = false,
+
             -- Name of the conversion function. Also used as a completion trigger.
             name = "to_json",
 
@@ -305,6 +604,17 @@ M.default = {
             trigger = "json"
         },
 
+        -- Set of enumerators stored as bits of a 64 bit word. Generated for enumerations with at most 64 enumerators.
+        set = {
+            -- Disabled by default.
+            enabled = false,
+
+            -- Name of the set class template. Also used as a completion trigger.
+            name    = "EnumSet",
+            -- Additional completion trigger if present.
+            trigger = "enumset"
+        },
+
         -- Switch statement generator.
         switch = {
             -- Enabled by default.
@@ -0,0 +1,140 @@
+local log = require('cppgen.log')
+local lsp = require('cppgen.lsp')
+
+---------------------------------------------------------------------------------------------------
+--- Recorded language server responses. While recording, the responses to the AST and type
+--- definition requests are captured. Stopping the recording saves them as a fixture file, which a
+--- fake client replays later without a live clangd.
+---------------------------------------------------------------------------------------------------
+
+---------------------------------------------------------------------------------------------------
+-- Global parameters. Initialized in setup.
+---------------------------------------------------------------------------------------------------
+local G = {}
+
+---------------------------------------------------------------------------------------------------
+-- Local parameters. Fixture being recorded.
+---------------------------------------------------------------------------------------------------
+local L = {
+    recording = nil,
+}
+
+local M = {}
+
+-- Fixture file format version
+local VERSION = 1
+
+---------------------------------------------------------------------------------------------------
+--- Return the fixture directory.
+---------------------------------------------------------------------------------------------------
+function M.directory()
+    return G.fixtures.directory or vim.fn.stdpath('data') .. '/cppgen/fixtures'
+end
+
+---------------------------------------------------------------------------------------------------
+--- Return the key of a request. Documents are identified by file name only, so the fixtures do not
+--- depend on where the sources were checked out.
+---------------------------------------------------------------------------------------------------
+function M.key(method, params)
+    local key = method .. ' ' .. vim.fs.basename(vim.uri_to_fname(params.textDocument.uri))
+    if params.position then
+        key = key .. ':' .. params.position.line .. ':' .. params.position.character
+    end
+    return key
+end
+
+---------------------------------------------------------------------------------------------------
+--- Returns true while recording.
+---------------------------------------------------------------------------------------------------
+function M.recording()
+    return L.recording ~= nil
+end
+
+---------------------------------------------------------------------------------------------------
+--- Start recording responses for the given buffer.
+---------------------------------------------------------------------------------------------------
+function M.start(bufnr)
+    L.recording = {
+        version   = VERSION,
+        file      = vim.fs.basename(vim.api.nvim_buf_get_name(bufnr)),
+        responses = {},
+    }
+    lsp.observe(function(method, params, result)
+        L.recording.responses[M.key(method, params)] = result
+    end)
+    log.info("Recording responses for", log.squoted(L.recording.file))
+end
+
+---------------------------------------------------------------------------------------------------
+--- Stop recording and save the fixture. Returns the fixture file name.
+---------------------------------------------------------------------------------------------------
+function M.stop()
+    lsp.observe(nil)
+    local fixture = L.recording
+    L.recording   = nil
+    if fixture == nil then
+        return nil
+    end
+
+    vim.fn.mkdir(M.directory(), 'p')
+    local path = M.directory() .. '/' .. fixture.file .. '.json'
+    local file = io.open(path, 'w')
+    if file == nil then
+        log.error("Unable to write fixture file", path)
+        return nil
+    end
+    file:write(vim.json.encode(fixture))
+    file:close()
+    log.info("Saved fixture", log.squoted(path))
+    return path
+end
+
+---------------------------------------------------------------------------------------------------
+--- Load a fixture file.
+---------------------------------------------------------------------------------------------------
+function M.load(path)
+    local file = io.open(path, 'r')
+    if file == nil then
+        log.error("Unable to read fixture file", path)
+        return nil
+    end
+    local text = file:read('*a')
+    file:close()
+
+    local ok, fixture = pcall(vim.json.decode, text, { luanil = { object = true, array = true } })
+    if not ok or type(fixture) ~= 'table' or fixture.version ~= VERSION then
+        log.error("Invalid fixture file", path)
+        return nil
+    end
+    return fixture
+end
+
+---------------------------------------------------------------------------------------------------
+--- Return a fake client replaying the fixture responses. Responses are delivered synchronously,
+--- requests that were not recorded fail.
+---------------------------------------------------------------------------------------------------
+function M.client(fixture)
+    return {
+        id      = 0,
+        name    = 'replay',
+        request = function(method, params, handler)
+            local result = fixture.responses[M.key(method, params)]
+            if result == nil then
+                handler({ code = -32601, message = 'Not recorded: ' .. M.key(method, params) }, nil, {})
+            else
+                handler(nil, result, {})
+            end
+            return true, 0
+        end,
+    }
+end
+
+---------------------------------------------------------------------------------------------------
+--- Initialization callback
+---------------------------------------------------------------------------------------------------
+function M.setup(opts)
+    log.trace("setup")
+    G.fixtures = opts.fixtures
+end
+
+return M
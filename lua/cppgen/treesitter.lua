@@ -0,0 +1,288 @@
+local ast = require('cppgen.ast')
+local log = require('cppgen.log')
+
+---------------------------------------------------------------------------------------------------
+--- Tree-sitter AST provider. Converts the buffer's C++ parse tree into nodes shaped like the clangd
+--- textDocument/ast nodes: { role, kind, detail, range, children }. Only the constructs the
+--- generators look at are converted. Everything else is skipped, with its relevant descendants
+--- hoisted into the nearest converted ancestor. The parse tree is syntactic, so field and alias
+--- types are classified by the types declared in the same buffer.
+---------------------------------------------------------------------------------------------------
+
+local M = {}
+
+-- Tree-sitter node types of class like declarations
+local records = {
+    struct_specifier = true,
+    class_specifier  = true,
+    union_specifier  = true,
+}
+
+-- Tree-sitter node types of builtin types
+local builtins = {
+    primitive_type       = true,
+    sized_type_specifier = true,
+}
+
+-- Return clangd style range of a tree-sitter node
+local function range(tsnode)
+    local srow, scol, erow, ecol = tsnode:range()
+    return { start = { line = srow, character = scol }, ['end'] = { line = erow, character = ecol } }
+end
+
+-- Return node text with white space collapsed
+local function text(tsnode, bufnr)
+    return (string.gsub(vim.treesitter.get_node_text(tsnode, bufnr), '%s+', ' '))
+end
+
+-- Return the first child in a given field, nil if there is none
+local function field(tsnode, name)
+    return tsnode:field(name)[1]
+end
+
+-- Converter state for a single conversion
+local C = {}
+
+-- Name of the declared type. Template arguments of specializations are kept.
+local function type_name(tsnode)
+    local name = field(tsnode, 'name')
+    return name and text(name, C.bufnr)
+end
+
+-- Collect names of enumerations and classes declared in the buffer, used to classify types.
+local function declared_types(tsnode, types)
+    local t = tsnode:type()
+    if (t == 'enum_specifier' or records[t]) and field(tsnode, 'body') then
+        local name = type_name(tsnode)
+        if name then
+            types[name] = t == 'enum_specifier' and 'Enum' or 'Record'
+        end
+    end
+    for child in tsnode:iter_children() do
+        if child:named() then
+            declared_types(child, types)
+        end
+    end
+    return types
+end
+
+-- Convert the type part of a declaration into a type node.
+local function type_node(tsnode)
+    local t    = tsnode:type()
+    local name = text(tsnode, C.bufnr)
+    local kind = 'Typedef'
+    if field(tsnode, 'body') then
+        name = type_name(tsnode) or ('anonymous ' .. string.match(t, '^(%a+)'))
+        kind = t == 'enum_specifier' and 'Enum' or 'Record'
+    elseif builtins[t] then
+        kind = 'Builtin'
+    elseif t == 'template_type' then
+        kind = C.types[text(field(tsnode, 'name') or tsnode, C.bufnr)] or 'TemplateSpecialization'
+    else
+        kind = C.types[name] or C.types[string.match(name, '([%w_]+)$') or name] or kind
+    end
+    return { role = 'type', kind = kind, detail = name, range = range(tsnode) }
+end
+
+-- Return the identifier declared by a field declarator, nil for member function declarations.
+local function declarator_name(tsnode)
+    local t = tsnode:type()
+    if t == 'field_identifier' or t == 'identifier' then
+        return tsnode
+    end
+    if t == 'function_declarator' then
+        return nil
+    end
+    local inner = field(tsnode, 'declarator')
+    return inner and declarator_name(inner)
+end
+
+-- Track #pragma pack state, so that classes declared while it is active carry the alignment attribute.
+local function pragma(tsnode)
+    local directive = field(tsnode, 'directive')
+    local argument  = field(tsnode, 'argument')
+    if not directive or not argument or text(directive, C.bufnr) ~= '#pragma' then
+        return
+    end
+    local args = string.match(text(argument, C.bufnr), '^%s*pack%s*%((.*)%)')
+    if args == nil then
+        return
+    end
+    if string.match(args, '^%s*push') then
+        table.insert(C.pack, string.match(args, '%d+') ~= nil)
+    elseif string.match(args, '^%s*pop') then
+        table.remove(C.pack)
+    else
+        C.pack[math.max(#C.pack, 1)] = string.match(args, '%d+') ~= nil
+    end
+end
+
+local convert
+
+-- Convert named children, appending the resulting nodes to the given list.
+local function convert_children(tsnode, children)
+    for child in tsnode:iter_children() do
+        if child:named() then
+            convert(child, children)
+        end
+    end
+    return children
+end
+
+-- Convert an enum specifier with a body.
+local function enum_node(tsnode)
+    local name     = type_name(tsnode)
+    local node     = { role = 'declaration', kind = 'Enum', detail = name or 'unnamed enum', range = range(tsnode), children = {} }
+    local base     = field(tsnode, 'base')
+    if base then
+        table.insert(node.children, type_node(base))
+    end
+    for child in field(tsnode, 'body'):iter_children() do
+        if child:type() == 'enumerator' then
+            local constant = { role = 'declaration', kind = 'EnumConstant', detail = text(field(child, 'name'), C.bufnr), range = range(child) }
+            local value    = field(child, 'value')
+            if value then
+                local t    = value:type()
+                local kind = t == 'number_literal' and 'IntegerLiteral' or (t == 'char_literal' and 'CharacterLiteral' or nil)
+                local expr = { role = 'expression', kind = 'ConstantExpr', range = range(value), children = {} }
+                if kind then
+                    table.insert(expr.children, { role = 'expression', kind = kind, detail = text(value, C.bufnr), range = range(value) })
+                end
+                constant.children = { expr }
+            end
+            table.insert(node.children, constant)
+        end
+    end
+    return node
+end
+
+-- Convert a class specifier with a body.
+local function record_node(tsnode, kind)
+    local name = type_name(tsnode)
+    local node = { role = 'declaration', kind = kind, detail = name or ('anonymous ' .. string.match(tsnode:type(), '^(%a+)')), range = range(tsnode), children = {} }
+    if C.pack[#C.pack] then
+        table.insert(node.children, { role = 'attribute', kind = 'MaxFieldAlignment' })
+    end
+    for child in tsnode:iter_children() do
+        if child:type() == 'attribute_specifier' and string.find(text(child, C.bufnr), 'packed') then
+            table.insert(node.children, { role = 'attribute', kind = 'Packed' })
+        end
+    end
+    convert_children(field(tsnode, 'body'), node.children)
+    return node
+end
+
+-- Convert a field declaration into one field node per declarator, preceded by nested type declarations.
+local function field_nodes(tsnode, children)
+    local type = field(tsnode, 'type')
+    if type and (type:type() == 'enum_specifier' or records[type:type()]) and field(type, 'body') then
+        convert(type, children)
+    end
+    for _, declarator in ipairs(tsnode:field('declarator')) do
+        local name = declarator_name(declarator)
+        if name then
+            local node = { role = 'declaration', kind = 'Field', detail = text(name, C.bufnr), range = range(tsnode), children = {} }
+            if type then
+                table.insert(node.children, type_node(type))
+            end
+            table.insert(children, node)
+        end
+    end
+end
+
+-- Convert a switch statement. The condition variable is resolved using clangd by the switch generator.
+local function switch_node(tsnode)
+    local node = { role = 'statement', kind = 'Switch', range = range(tsnode), children = {} }
+    local cond = field(tsnode, 'condition')
+    local function find(n)
+        if n:type() == 'identifier' then
+            return n
+        end
+        for child in n:iter_children() do
+            local found = child:named() and find(child)
+            if found then
+                return found
+            end
+        end
+        return nil
+    end
+    local ident = cond and find(cond)
+    if ident then
+        table.insert(node.children, { role = 'expression', kind = 'DeclRef', detail = text(ident, C.bufnr), range = range(ident) })
+    end
+    convert_children(field(tsnode, 'body') or tsnode, node.children)
+    return node
+end
+
+-- Convert a tree-sitter node, appending the resulting nodes to the given list.
+convert = function(tsnode, children)
+    local t = tsnode:type()
+    if t == 'enum_specifier' and field(tsnode, 'body') then
+        table.insert(children, enum_node(tsnode))
+    elseif records[t] and field(tsnode, 'body') then
+        table.insert(children, record_node(tsnode, 'CXXRecord'))
+    elseif t == 'template_declaration' then
+        for child in tsnode:iter_children() do
+            if records[child:type()] and field(child, 'body') then
+                table.insert(children, record_node(child, 'ClassTemplate'))
+            elseif child:named() and child:type() ~= 'template_parameter_list' then
+                convert(child, children)
+            end
+        end
+    elseif t == 'field_declaration' then
+        field_nodes(tsnode, children)
+    elseif t == 'alias_declaration' then
+        local type = field(tsnode, 'type')
+        table.insert(children, { role = 'declaration', kind = 'TypeAlias', detail = text(field(tsnode, 'name'), C.bufnr), range = range(tsnode),
+                                 children = { type_node(field(type, 'type') or type) } })
+    elseif t == 'namespace_definition' then
+        local name = field(tsnode, 'name')
+        local node = { role = 'declaration', kind = 'Namespace', detail = name and text(name, C.bufnr) or 'anonymous namespace', range = range(tsnode), children = {} }
+        table.insert(children, node)
+        convert_children(tsnode, node.children)
+    elseif t == 'function_definition' then
+        local node = { role = 'declaration', kind = 'Function', range = range(tsnode), children = {} }
+        table.insert(children, node)
+        convert_children(tsnode, node.children)
+    elseif t == 'switch_statement' then
+        table.insert(children, switch_node(tsnode))
+    elseif t == 'preproc_call' then
+        pragma(tsnode)
+    else
+        convert_children(tsnode, children)
+    end
+end
+
+---------------------------------------------------------------------------------------------------
+--- Returns true if the C++ tree-sitter parser is available for the buffer.
+---------------------------------------------------------------------------------------------------
+function M.available(bufnr)
+    local ok, parser = pcall(vim.treesitter.get_parser, bufnr, 'cpp')
+    return ok and parser ~= nil
+end
+
+---------------------------------------------------------------------------------------------------
+--- Parse the buffer and invoke callback on the converted tree. The parser is incremental, so only
+--- the edited parts of the buffer are parsed again.
+---------------------------------------------------------------------------------------------------
+function M.get_ast(bufnr, callback)
+    local ok, parser = pcall(vim.treesitter.get_parser, bufnr, 'cpp')
+    if not ok or parser == nil then
+        log.warn("No C++ tree-sitter parser for buffer", bufnr)
+        return
+    end
+    local tree = parser:parse()[1]
+    local root = tree:root()
+
+    C.bufnr = bufnr
+    C.types = declared_types(root, {})
+    C.pack  = {}
+
+    local symbols = { role = 'declaration', kind = 'TranslationUnit', children = {} }
+    convert_children(root, symbols.children)
+    log.info("Converted tree-sitter tree with", #symbols.children, "top level nodes")
+    log.trace(symbols)
+    callback((ast.compact(symbols)))
+end
+
+return M